@@ -3,14 +3,136 @@
 
 #include "DC_Chunk.h"
 
+template<typename T>
+static void QuantizeNoiseField(const TArray<float>& field, TArray<T>& out, float iso_surface, float range)
+{
+	constexpr float max_q = static_cast<float>(TNumericLimits<T>::Max());
+	const float scale = max_q / range;
+
+	out.SetNumUninitialized(field.Num());
+	for (int32 i = 0; i < field.Num(); i++)
+	{
+		const float d = (field[i] - iso_surface) * scale;
+		float q = FMath::Clamp(FMath::RoundToFloat(d), -max_q, max_q);
+
+		//solid is d <= 0, dont let small positive densities round onto the iso surface
+		if (d > 0.f && q <= 0.f) q = 1.f;
+
+		out[i] = static_cast<T>(q);
+	}
+}
+
+template<typename T>
+static void DequantizeNoiseField(const TArray<T>& field, TArray<float>& out, float iso_surface, float range)
+{
+	const float scale = range / static_cast<float>(TNumericLimits<T>::Max());
+
+	out.SetNumUninitialized(field.Num());
+	for (int32 i = 0; i < field.Num(); i++)
+	{
+		out[i] = iso_surface + static_cast<float>(field[i]) * scale;
+	}
+}
+
+void ChunkNoiseField::Encode(TArray<float>&& field, NoiseFieldStorage new_storage, float new_iso_surface, float new_range)
+{
+	Reset();
+
+	storage = new_storage;
+	iso_surface = new_iso_surface;
+	range = new_range;
+	num = field.Num();
+
+	switch (storage)
+	{
+	case NoiseFieldStorage::Raw:
+		raw = MoveTemp(field);
+		break;
+	case NoiseFieldStorage::Quantized16:
+		QuantizeNoiseField(field, quantized_16, iso_surface, range);
+		break;
+	case NoiseFieldStorage::Quantized8:
+		QuantizeNoiseField(field, quantized_8, iso_surface, range);
+		break;
+	}
+}
+
+void ChunkNoiseField::Decode(TArray<float>& out) const
+{
+	switch (storage)
+	{
+	case NoiseFieldStorage::Raw:
+		out = raw;
+		break;
+	case NoiseFieldStorage::Quantized16:
+		DequantizeNoiseField(quantized_16, out, iso_surface, range);
+		break;
+	case NoiseFieldStorage::Quantized8:
+		DequantizeNoiseField(quantized_8, out, iso_surface, range);
+		break;
+	}
+}
+
+float ChunkNoiseField::Get(int32 idx) const
+{
+	switch (storage)
+	{
+	case NoiseFieldStorage::Quantized16:
+		return iso_surface + static_cast<float>(quantized_16[idx]) * (range / static_cast<float>(TNumericLimits<int16>::Max()));
+	case NoiseFieldStorage::Quantized8:
+		return iso_surface + static_cast<float>(quantized_8[idx]) * (range / static_cast<float>(TNumericLimits<int8>::Max()));
+	default:
+		return raw[idx];
+	}
+}
+
+void ChunkNoiseField::Reset()
+{
+	raw.Empty();
+	quantized_16.Empty();
+	quantized_8.Empty();
+	num = 0;
+}
+
+void ChunkNoiseField::Serialize(FArchive& ar)
+{
+	uint8 storage_byte = static_cast<uint8>(storage);
+	ar << storage_byte;
+	storage = static_cast<NoiseFieldStorage>(storage_byte);
+
+	ar << iso_surface;
+	ar << range;
+	ar << num;
+
+	raw.BulkSerialize(ar);
+	quantized_16.BulkSerialize(ar);
+	quantized_8.BulkSerialize(ar);
+}
+
+SIZE_T ChunkNoiseField::GetAllocatedSize() const
+{
+	return raw.GetAllocatedSize() + quantized_16.GetAllocatedSize() + quantized_8.GetAllocatedSize();
+}
+
+SIZE_T Chunk::GetAllocatedSize() const
+{
+	SIZE_T size = node_arena.GetAllocatedSize() + linear_tree.GetAllocatedSize() + progressive_tree.GetAllocatedSize() + leaf_grid.GetAllocatedSize();
+	size += noise_field.GetAllocatedSize() + hermite.GetAllocatedSize() + sdf_ops.GetAllocatedSize();
+	interior_streams.ForEach([&size](const RealtimeMesh::FRealtimeMeshStream& stream) { size += stream.GetAllocatedSize(); });
+	return size;
+}
+
 Chunk::~Chunk()
 {
 	//delete root;
 }
 
-Chunk::Chunk(Chunk&& other) noexcept : root(MoveTemp(other.root)), center(other.center), mesh(other.mesh)
+Chunk::Chunk(Chunk&& other) noexcept : root(other.root), node_arena(MoveTemp(other.node_arena)), linear_tree(MoveTemp(other.linear_tree)), progressive_tree(MoveTemp(other.progressive_tree)), leaf_grid(MoveTemp(other.leaf_grid)), interior_streams(MoveTemp(other.interior_streams)), interior_pending(other.interior_pending), seam_groups(other.seam_groups), center(other.center), depth(other.depth), cut_depth(other.cut_depth), 
+	rmc_newly_created(other.rmc_newly_created), has_section_built(other.has_section_built), mesh(other.mesh), 
+	noise_field(MoveTemp(other.noise_field)), hermite(MoveTemp(other.hermite)), sdf_ops(MoveTemp(other.sdf_ops)),
+	cache_clean(other.cache_clean), lod_key(other.lod_key)
 {
-	//other.root = nullptr;
+	other.root = nullptr;
 	other.mesh = nullptr;
 }
 
@@ -19,11 +141,30 @@ Chunk& Chunk::operator=(Chunk&& other) noexcept
 	if(this != &other)
 	{
 		center = other.center;
+		depth = other.depth;
+		cut_depth = other.cut_depth;
 
 		mesh = other.mesh;
 		other.mesh = nullptr;
 
-		root = MoveTemp(other.root);
+		root = other.root;
+		other.root = nullptr;
+		node_arena = MoveTemp(other.node_arena);
+		linear_tree = MoveTemp(other.linear_tree);
+		progressive_tree = MoveTemp(other.progressive_tree);
+		leaf_grid = MoveTemp(other.leaf_grid);
+		interior_streams = MoveTemp(other.interior_streams);
+		interior_pending = other.interior_pending;
+		seam_groups = other.seam_groups;
+
+		rmc_newly_created = other.rmc_newly_created;
+		has_section_built = other.has_section_built;
+		noise_field = MoveTemp(other.noise_field);
+		hermite = MoveTemp(other.hermite);
+		sdf_ops = MoveTemp(other.sdf_ops);
+
+		cache_clean = other.cache_clean;
+		lod_key = other.lod_key;
 	}
 	
 	return *this;
@@ -13,6 +13,7 @@
 #include "RealtimeMeshComponent.h"
 #include "RealtimeMeshSimple.h"
 #include "DC_NoiseDataGenerator.h"
+#include "Misc/Paths.h"
 
 #define USE_NAMED_STATS 1
 
@@ -75,6 +76,7 @@ void UChunkProvider::Init(bool simulating)
 	const int32 thread_num = FMath::Max(1, FPlatformMisc::NumberOfWorkerThreadsToSpawn() - 2);
 	const int32 stack_size = 256*1024;
 	const EThreadPriority thread_prio = EThreadPriority::TPri_Normal;
+	pool_thread_num = thread_num;
 	thread_pool->Create(thread_num, stack_size, thread_prio, TEXT("DC_ThreadPool"));
 
 	/*Params.Name = TEXT("TerrainFollowTest");
@@ -86,7 +88,10 @@ void UChunkProvider::Cleanup(bool simulating)
 {
 	UE_LOG(LogTemp, Display, TEXT(" CLEANUP called on: %i"), GetWorld()->WorldType.GetIntValue());
 
+	//written out while the pool is still around to compress them
+	CacheLoadedChunks();
 	chunk_grid.Cleanup();
+	region_cache.Reset();
 
 	render_actor->DestroyAllRMCs();
 
@@ -119,8 +124,28 @@ void UChunkProvider::Deinitialize()
 
 void UChunkProvider::ReloadChunks()
 {
+	OctreeSettingsMultithreadContext new_settings;
+	new_settings = *GetDefault<UOctreeSettings>();
+
+	//compared against what the loaded chunks were built with, so changes piling up before the next tick add up
+	const SettingsInvalidation invalidation = new_settings.GetInvalidation(built_settings);
+	if (invalidation != SettingsInvalidation::Noise)
+	{
+		pending_invalidation = invalidation;
+		return;
+	}
+
+	//the loaded chunks are cached with the settings they were sampled with
+	CacheLoadedChunks();
+
+	built_settings = new_settings;
+	built_noise_hash = GetCacheNoiseHash(built_settings);
+	pending_invalidation = SettingsInvalidation::None;
+
 	chunk_grid.Cleanup();
 
+	UNoiseDataGenerator::SetGridChunkSize(chunk_settings->chunk_size);
+
 	render_actor->DestroyAllRMCs();
 
 	FVector cam_pos = GetActiveCameraLocation();
@@ -131,11 +156,27 @@ void UChunkProvider::ReloadChunks()
 
 void UChunkProvider::ReloadReallocChunks()
 {
+	//chunk provider settings changed already, built_noise_hash still is the one the loaded chunks were sampled with
+	CacheLoadedChunks();
+
+	built_settings = *GetDefault<UOctreeSettings>();
+	built_noise_hash = GetCacheNoiseHash(built_settings);
+	pending_invalidation = SettingsInvalidation::None;
+
 	chunk_grid.Cleanup();
 
+	//editor and play worlds of a map share their region files
+	region_cache.Reset();
+	if (chunk_settings->use_region_cache)
+	{
+		region_cache.Init(FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("DCRegionCache"), UWorld::RemovePIEPrefix(GetWorld()->GetMapName())), *thread_pool);
+	}
+
+	UNoiseDataGenerator::SetGridChunkSize(chunk_settings->chunk_size);
+
 	render_actor->DestroyAllRMCs();
 
-	chunk_grid.Realloc(chunk_settings->chunk_load_distance);
+	chunk_grid.Realloc(chunk_settings->chunk_load_distance, chunk_settings->chunk_ping_deletion_at);
 
 	FVector cam_pos = GetActiveCameraLocation();
 	FIntVector current_chunk_coord = GetChunkCoordinatesFromPosition(FVector3f(cam_pos));
@@ -143,144 +184,514 @@ void UChunkProvider::ReloadReallocChunks()
 	build_initial_area = true;
 }
 
-void UChunkProvider::BuildChunkArea(FIntVector3 current_chunk_coord)
+void UChunkProvider::RederiveChunks(SettingsInvalidation invalidation)
 {
-	TArray<FIntVector3> chunk_coords = GetChunkArea(current_chunk_coord);
+	const bool recut = invalidation == SettingsInvalidation::Recut;
 
-	for (int32 i = 0; i < chunk_coords.Num(); i++)
+	chunk_grid.ForEachChunk([&](const FIntVector3& c, Chunk& chunk)
+		{
+			//signs did not change, chunks without a surface stay without one
+			const bool rebuild = recut ? !chunk.progressive_tree.IsEmpty() : chunk.HasSurface();
+
+			if (rebuild)
+			{
+				//normals sampled with the old fdm offset or gradients are of no use anymore
+				if (invalidation == SettingsInvalidation::Hermite) chunk.hermite.Reset();
+
+				chunk_grid.chunk_creation_jobs.Add(ChunkCreationJob{c, recut ? CreationTaskArg::Recut : CreationTaskArg::Rederive});
+				chunk_grid.pending_creations.FindOrAdd(c)++;
+			}
+
+			//every chunk is rebuilt, re-stitching the strips each one owns covers every seam
+			if (rebuild || chunk.seam_groups) MeshChunk(c, chunk.seam_groups ? PolygonizeTaskArg::SeamsOnly : PolygonizeTaskArg::Area);
+		});
+}
+
+void UChunkProvider::BuildChunkArea(FIntVector3 current_chunk_coord)
+{
+	for (const FIntVector3& offset : chunk_grid.area_offsets)
 	{
-		FIntVector3 world_coord = chunk_coords[i];
+		FIntVector3 world_coord = offset + current_chunk_coord;
 
-		if(chunk_grid.chunks.Contains(world_coord)) continue;
+		if(chunk_grid.Contains(world_coord)) continue;
 
 		CreateChunk(world_coord);
 		MeshChunk(world_coord, PolygonizeTaskArg::Area);
 	}
 }
 
-TArray<FIntVector3> UChunkProvider::GetChunkArea(FIntVector3 around)
+void UChunkProvider::EvictSlabs(FIntVector3 delta, FIntVector3 previous_generator_pos)
 {
-	TArray<FIntVector3> local_chunk_indices;
-	float size = chunk_settings->chunk_size;
-	int32 load_dist = (chunk_grid.dim-1) / 2;
+	const int32 load_dist = (chunk_grid.dim - 1) / 2;
+	const int32 step = ++chunk_grid.generator_steps;
 
-	local_chunk_indices.Reserve(chunk_grid.dim*chunk_grid.dim*chunk_grid.dim);
-	for (int32 x = -load_dist; x < load_dist+1; x++)
+	//the trailing face of the previous area on every axis the generator moved along
+	TArray<FIntVector3> left_coords;
+	for (int32 axis = 0; axis < 3; axis++)
 	{
-		for (int32 y = -load_dist; y < load_dist+1; y++)
+		if (!delta[axis]) continue;
+
+		const int32 u_axis = (axis + 1) % 3;
+		const int32 v_axis = (axis + 2) % 3;
+
+		FIntVector3 c;
+		c[axis] = previous_generator_pos[axis] - delta[axis] * load_dist;
+		for (int32 u = -load_dist; u < load_dist + 1; u++)
 		{
-			for (int32 z = -load_dist; z < load_dist+1; z++)
+			c[u_axis] = previous_generator_pos[u_axis] + u;
+			for (int32 v = -load_dist; v < load_dist + 1; v++)
 			{
-				//if(x*x + y*y + z*z > load_dist*load_dist) continue;
-
-				local_chunk_indices.Add(FIntVector3(x, y, z));
+				c[v_axis] = previous_generator_pos[v_axis] + v;
+				if (chunk_grid.Contains(c)) left_coords.Add(c);
 			}
 		}
 	}
-	
-	local_chunk_indices.Sort([](const FIntVector3& a, const FIntVector3& b)
+	if (!left_coords.IsEmpty()) chunk_grid.left_slabs.Emplace(step, MoveTemp(left_coords));
+
+	//chunks get chunk_ping_deletion_at generator steps to come back into the area before they are deleted
+	int32 expired = 0;
+	for (; expired < chunk_grid.left_slabs.Num() && chunk_grid.left_slabs[expired].Key + chunk_settings->chunk_ping_deletion_at <= step; expired++)
 	{
-		int64 dist_a = static_cast<int64>(a.X) * a.X + static_cast<int64>(a.Y) * a.Y + static_cast<int64>(a.Z) * a.Z;
-		int64 dist_b = static_cast<int64>(b.X) * b.X + static_cast<int64>(b.Y) * b.Y + static_cast<int64>(b.Z) * b.Z;
+		for (const FIntVector3& c : chunk_grid.left_slabs[expired].Value)
+		{
+			const FIntVector3 d = c - chunk_grid.current_generator_pos;
+			if (FMath::Max3(FMath::Abs(d.X), FMath::Abs(d.Y), FMath::Abs(d.Z)) <= load_dist) continue;
 
-		return dist_a < dist_b;
-	});
+			//corner chunks can sit in more than one slab
+			if (!chunk_grid.Contains(c)) continue;
+
+			EvictChunk(c);
+		}
+	}
+	chunk_grid.left_slabs.RemoveAt(0, expired, EAllowShrinking::No);
+}
+
+void UChunkProvider::CopyNoiseFieldBoundaries(const FIntVector3& coord, int32 dim, TArray<float>& noise, FIntVector3& sample_min, FIntVector3& sample_max)
+{
+	sample_min = FIntVector3(0);
+	sample_max = FIntVector3(dim - 1);
+
+	//neighbour planes may be snapped against chunks that are not our neighbours
+	if (chunk_settings->lod_ring_width > 0) return;
+
+	for (int32 axis = 0; axis < 3; axis++)
+	{
+		const int32 u_axis = (axis + 1) % 3;
+		const int32 v_axis = (axis + 2) % 3;
+
+		for (int32 side = -1; side <= 1; side += 2)
+		{
+			FIntVector3 offset = FIntVector3(0);
+			offset[axis] = side;
+
+			//edited fields no longer hold plain noise, quantized ones only approximate it and are sampled again
+			Chunk* neighbor = chunk_grid.TryGet(coord + offset);
+			if (!neighbor || neighbor->noise_field.Num() != dim * dim * dim || neighbor->noise_field.IsQuantized() || !neighbor->sdf_ops.IsEmpty()) continue;
+
+			const int32 own_plane = side < 0 ? 0 : dim - 1;
+			const int32 neighbor_plane = side < 0 ? dim - 1 : 0;
+
+			FIntVector3 own_idx, neighbor_idx;
+			own_idx[axis] = own_plane;
+			neighbor_idx[axis] = neighbor_plane;
+
+			for (int32 u = 0; u < dim; u++)
+			{
+				own_idx[u_axis] = neighbor_idx[u_axis] = u;
+				for (int32 v = 0; v < dim; v++)
+				{
+					own_idx[v_axis] = neighbor_idx[v_axis] = v;
+					noise[UOctreeCode::Get1DIndexFrom3D(own_idx.X, own_idx.Y, own_idx.Z, dim)] = neighbor->noise_field.Get(UOctreeCode::Get1DIndexFrom3D(neighbor_idx.X, neighbor_idx.Y, neighbor_idx.Z, dim));
+				}
+			}
+
+			if (side < 0) sample_min[axis] = 1;
+			else sample_max[axis] = dim - 2;
+		}
+	}
+}
+
+void UChunkProvider::BuildNoiseField(TArray<float>& noise, const FIntVector3& coord, const FIntVector3& sample_min, const FIntVector3& sample_max, int32 max_depth, int32 noise_seed)
+{
+	const int32 dim = UOctreeCode::GetDim(max_depth) + 1;
+	checkSlow(noise.Num() == dim * dim * dim);
+
+	//grid points line up across chunks, the first one of this chunk is coord * 2^depth
+	const FIntVector3 grid_start = coord * UOctreeCode::GetDim(max_depth) + sample_min;
+
+	UNoiseDataGenerator::GetNoiseUniformGrid3D(noise.GetData(), dim, sample_min, grid_start, sample_max - sample_min + FIntVector3(1), max_depth, noise_seed);
+}
 
-	for (auto& c : local_chunk_indices)
+void UChunkProvider::BuildChunkTree(ChunkCreationResult& result, const FVector3f& center, float size, const OctreeSettingsMultithreadContext& settings_context, const TArray<float>& noise_field, const TArray<FSDFOp>* sdf_ops, int32 depth_cut, HermiteData* hermite)
+{
+	if (settings_context.progressive_octree)
+	{
+		UOctreeCode::BuildProgressiveOctree(center, size, settings_context, noise_field, sdf_ops, result.created_progressive_tree, hermite);
+		UOctreeCode::ExtractOctree(result.created_progressive_tree, settings_context, depth_cut, result.created_linear_tree);
+	}
+	else if (settings_context.uniform_leaf_grid && !settings_context.simplify)
 	{
-		c += around; 
+		UOctreeCode::BuildUniformLeafGrid(center, size, settings_context, noise_field, sdf_ops, result.created_leaf_grid, hermite);
 	}
+	else if (settings_context.linear_octree)
+	{
+		if (sdf_ops) UOctreeCode::RebuildOctree(center, size, settings_context, noise_field, *sdf_ops, result.created_linear_tree, hermite);
+		else UOctreeCode::BuildOctree(center, size, settings_context, noise_field, result.created_linear_tree, hermite);
+	}
+	else
+	{
+		if (sdf_ops) result.created_root = UOctreeCode::RebuildOctree(center, size, settings_context, noise_field, *sdf_ops, result.node_arena, hermite);
+		else result.created_root = UOctreeCode::BuildOctree(center, size, settings_context, noise_field, result.node_arena, hermite);
+	}
+}
 
-	return local_chunk_indices;
+void UChunkProvider::PolygonizeChunkInterior(ChunkCreationResult& result)
+{
+	if (result.created_root)
+	{
+		result.created_interior = UOctreeCode::PolygonizeInterior(result.created_root);
+	}
+	else if (!result.created_linear_tree.IsEmpty())
+	{
+		result.created_interior = UOctreeCode::PolygonizeInterior(result.created_linear_tree);
+	}
+	else if (!result.created_leaf_grid.IsEmpty())
+	{
+		result.created_interior = UOctreeCode::PolygonizeInterior(result.created_leaf_grid);
+	}
 }
 
-TArray<float> UChunkProvider::BuildNoiseField(const FVector3f& center, float size, int32 max_depth, int32 noise_seed)
+void UChunkProvider::EditNoiseField(TArray<float>& noise, const FVector3f& center, float size, int32 max_depth, const FSDFOp& sdf_op)
 {
-	int32 dim = UOctreeCode::GetDim(max_depth) + 1;
+#if USE_NAMED_STATS
+	QUICK_SCOPE_CYCLE_COUNTER(Stat_EditNoiseField)
+#endif
+
+	const int32 dim = UOctreeCode::GetDim(max_depth) + 1;
+
+	const FVector3f min = center - size * 0.5f;
+	const float vox_size = size / (dim - 1);
+
+	//samples outside of the op's influence keep their value, only walk the index box inside it
+	const FBox3f bounds = sdf_op.GetInfluenceBounds();
+	const FVector3f bounds_min = (bounds.Min - min) / vox_size;
+	const FVector3f bounds_max = (bounds.Max - min) / vox_size;
+
+	const FIntVector3 idx_min = FIntVector3(FMath::Max(FMath::CeilToInt(bounds_min.X), 0), FMath::Max(FMath::CeilToInt(bounds_min.Y), 0), FMath::Max(FMath::CeilToInt(bounds_min.Z), 0));
+	const FIntVector3 idx_max = FIntVector3(FMath::Min(FMath::FloorToInt(bounds_max.X), dim - 1), FMath::Min(FMath::FloorToInt(bounds_max.Y), dim - 1), FMath::Min(FMath::FloorToInt(bounds_max.Z), dim - 1));
+
+	if (idx_min.X > idx_max.X || idx_min.Y > idx_max.Y || idx_min.Z > idx_max.Z) return;
 
-	TArray<float> x_pos, y_pos, z_pos;
-	x_pos.SetNumUninitialized(dim * dim * dim);
-	y_pos.SetNumUninitialized(dim * dim * dim);
-	z_pos.SetNumUninitialized(dim * dim * dim);
+	//op local sample space, same 0.01 scaling as the noise
+	const float step = vox_size * 0.01f;
+	const FVector3f origin = (min - sdf_op.position) * 0.01f;
+	const FVector3f extent = (sdf_op.bounds_size * 0.5f) * 0.01f;
 
-	FVector3f min = center - size * 0.5f;
-	float vox_size = size / (dim - 1);
+	const bool is_box = sdf_op.sdf_type == SDFType::Box;
+	const bool subtract = sdf_op.mod_type == ModType::Subtract;
 
-	for (int32 x = 0; x < dim; x++)
+	//z is the contiguous axis, 4 samples along it per iteration
+	const VectorRegister4Float lane_offsets = VectorSet(0.f, step, 2.f * step, 3.f * step);
+
+	for (int32 x = idx_min.X; x <= idx_max.X; x++)
 	{
-		for (int32 y = 0; y < dim; y++)
+		const float px = origin.X + x * step;
+		const VectorRegister4Float px_4 = VectorSetFloat1(px);
+
+		for (int32 y = idx_min.Y; y <= idx_max.Y; y++)
 		{
-			for (int32 z = 0; z < dim; z++)
+			const float py = origin.Y + y * step;
+			const VectorRegister4Float py_4 = VectorSetFloat1(py);
+
+			float* row = noise.GetData() + UOctreeCode::Get1DIndexFrom3D(x, y, 0, dim);
+
+			int32 z = idx_min.Z;
+			for (; z + 3 <= idx_max.Z; z += 4)
+			{
+				const VectorRegister4Float pz_4 = VectorAdd(VectorSetFloat1(origin.Z + z * step), lane_offsets);
+				const VectorRegister4Float sdf_4 = is_box ? SDF::Box(px_4, py_4, pz_4, extent) : SDF::Sphere(px_4, py_4, pz_4, extent.X);
+
+				const VectorRegister4Float noise_4 = VectorLoad(row + z);
+				VectorStore(subtract ? VectorMax(noise_4, VectorNegate(sdf_4)) : VectorMin(noise_4, sdf_4), row + z);
+			}
+
+			for (; z <= idx_max.Z; z++)
 			{
-				int32 idx = UOctreeCode::Get1DIndexFrom3D(x, y, z, dim);
-				x_pos[idx] = (min.X + vox_size * x) * 0.01f;
-				y_pos[idx] = (min.Y + vox_size * y) * 0.01f;
-				z_pos[idx] = (min.Z + vox_size * z) * 0.01f;
+				const FVector3f local_pos = FVector3f(px, py, origin.Z + z * step);
+				const float sdf_val = is_box ? SDF::Box(local_pos, extent) : SDF::Sphere(local_pos, extent.X);
+
+				row[z] = subtract ? FMath::Max(row[z], -sdf_val) : FMath::Min(row[z], sdf_val);
 			}
 		}
 	}
+}
+
+void UChunkProvider::SnapNoiseFieldBoundaries(TArray<float>& noise, int32 depth, const TStaticArray<int32, 27>& neighbor_depths)
+{
+#if USE_NAMED_STATS
+	QUICK_SCOPE_CYCLE_COUNTER(Stat_SnapNoiseFieldBoundaries)
+#endif
 
-	TArray<float> noise;
+	const int32 dim = UOctreeCode::GetDim(depth) + 1;
+
+	//edge lines go first, face samples interpolate between lattice samples on the edges that are final by then.
+	//corners are lattice samples of every depth and never change
+	for (int32 pass_free_axes = 1; pass_free_axes <= 2; pass_free_axes++)
 	{
-		noise = UNoiseDataGenerator::GetNoiseFromPositions3D_NonThreaded(x_pos.GetData(), y_pos.GetData(), z_pos.GetData(), dim * dim * dim, noise_seed);
+		for (int32 x = 0; x < dim; x++)
+		{
+			for (int32 y = 0; y < dim; y++)
+			{
+				//only the boundary of the field, inside the x / y interior that is the first and last z
+				const bool xy_interior = x > 0 && x < dim - 1 && y > 0 && y < dim - 1;
+				const int32 z_step = xy_interior ? dim - 1 : 1;
+
+				for (int32 z = 0; z < dim; z += z_step)
+				{
+					const FIntVector3 p = FIntVector3(x, y, z);
+
+					//neighbour offsets sharing p per axis, axes without a neighbour are free to interpolate along
+					FIntVector3 offset_min, offset_max;
+					int32 free_axes = 0;
+					for (int32 axis = 0; axis < 3; axis++)
+					{
+						offset_min[axis] = p[axis] == 0 ? -1 : 0;
+						offset_max[axis] = p[axis] == dim - 1 ? 1 : 0;
+						free_axes += !offset_min[axis] && !offset_max[axis];
+					}
+					if (free_axes != pass_free_axes) continue;
+
+					int32 min_depth = depth;
+					for (int32 ox = offset_min.X; ox <= offset_max.X; ox++)
+					{
+						for (int32 oy = offset_min.Y; oy <= offset_max.Y; oy++)
+						{
+							for (int32 oz = offset_min.Z; oz <= offset_max.Z; oz++)
+							{
+								min_depth = FMath::Min(min_depth, neighbor_depths[(ox + 1) * 9 + (oy + 1) * 3 + (oz + 1)]);
+							}
+						}
+					}
+					if (min_depth >= depth) continue;
+
+					//lattice of the coarsest chunk, its samples are a subset of ours
+					const int32 step = 1 << (depth - min_depth);
+
+					FIntVector3 base = p;
+					FVector3f t = FVector3f::ZeroVector;
+					bool on_lattice = true;
+					for (int32 axis = 0; axis < 3; axis++)
+					{
+						if (offset_min[axis] || offset_max[axis]) continue;
+
+						base[axis] = (p[axis] / step) * step;
+						t[axis] = static_cast<float>(p[axis] - base[axis]) / step;
+						on_lattice &= base[axis] == p[axis];
+					}
+					if (on_lattice) continue;
+
+					float value = 0.f;
+					for (int32 corner = 0; corner < 8; corner++)
+					{
+						float weight = 1.f;
+						FIntVector3 q = base;
+						for (int32 axis = 0; axis < 3 && weight > 0.f; axis++)
+						{
+							const int32 bit = (corner >> axis) & 1;
+							if (offset_min[axis] || offset_max[axis])
+							{
+								if (bit) weight = 0.f;
+								continue;
+							}
+
+							weight *= bit ? t[axis] : 1.f - t[axis];
+							q[axis] += bit * step;
+						}
+						if (weight <= 0.f) continue;
+
+						value += weight * noise[UOctreeCode::Get1DIndexFrom3D(q.X, q.Y, q.Z, dim)];
+					}
+
+					noise[UOctreeCode::Get1DIndexFrom3D(x, y, z, dim)] = value;
+				}
+			}
+		}
 	}
+}
+
+FIntVector3 UChunkProvider::GetLodCenter(const FIntVector3& generator_pos) const
+{
+	const int32 ring_width = chunk_settings->lod_ring_width;
+	if (ring_width <= 0) return generator_pos;
 
-	return noise;
+	//the center of the ring width cell the generator is in, so the camera never sits close to the edge of the finest ring
+	auto snap = [ring_width](int32 v) { return FMath::FloorToInt(static_cast<float>(v) / ring_width) * ring_width + ring_width / 2; };
+	return FIntVector3(snap(generator_pos.X), snap(generator_pos.Y), snap(generator_pos.Z));
 }
 
-void UChunkProvider::EditNoiseField(TArray<float>& noise, const FVector3f& center, float size, int32 max_depth, const FSDFOp& sdf_op)
+int32 UChunkProvider::GetChunkDepth(const FIntVector3& coord) const
 {
-	int32 dim = UOctreeCode::GetDim(max_depth) + 1;
+	const int32 max_depth = GetDefault<UOctreeSettings>()->max_depth;
+	const int32 ring_width = chunk_settings->lod_ring_width;
+	if (ring_width <= 0) return max_depth;
 
-	TArray<float> x_pos, y_pos, z_pos;
-	x_pos.SetNumUninitialized(dim * dim * dim);
-	y_pos.SetNumUninitialized(dim * dim * dim);
-	z_pos.SetNumUninitialized(dim * dim * dim);
+	const FIntVector3 d = coord - chunk_grid.lod_center;
+	const int32 ring = FMath::Max3(FMath::Abs(d.X), FMath::Abs(d.Y), FMath::Abs(d.Z)) / ring_width;
 
-	FVector3f min = center - size * 0.5f;
-	float vox_size = size / (dim - 1);
+	return FMath::Max(max_depth - ring, FMath::Min(chunk_settings->lod_min_depth, max_depth));
+}
 
-	for (int32 x = 0; x < dim; x++)
+void UChunkProvider::GetNeighborDepths(const FIntVector3& coord, TStaticArray<int32, 27>& neighbor_depths) const
+{
+	for (int32 x = -1; x < 2; x++)
 	{
-		for (int32 y = 0; y < dim; y++)
+		for (int32 y = -1; y < 2; y++)
 		{
-			for (int32 z = 0; z < dim; z++)
+			for (int32 z = -1; z < 2; z++)
 			{
-				int32 idx = UOctreeCode::Get1DIndexFrom3D(x, y, z, dim);
-				x_pos[idx] = (min.X + vox_size * x) * 0.01f;
-				y_pos[idx] = (min.Y + vox_size * y) * 0.01f;
-				z_pos[idx] = (min.Z + vox_size * z) * 0.01f;
+				neighbor_depths[(x + 1) * 9 + (y + 1) * 3 + (z + 1)] = GetChunkDepth(coord + FIntVector3(x, y, z));
 			}
 		}
 	}
+}
+
+//a cached noise field is only of use next to neighbours of the depths it was snapped against
+static uint32 GetLodKey(const TStaticArray<int32, 27>& neighbor_depths)
+{
+	return FCrc::MemCrc32(neighbor_depths.GetData(), sizeof(int32) * neighbor_depths.Num());
+}
 
-	for (int32 i = 0; i < dim * dim * dim; i++)
+uint32 UChunkProvider::GetChunkLodKey(const FIntVector3& coord, int32 depth) const
+{
+	if (chunk_settings->lod_ring_width <= 0) return 0;
+
+	TStaticArray<int32, 27> neighbor_depths;
+	GetNeighborDepths(coord, neighbor_depths);
+	neighbor_depths[13] = depth;
+	return GetLodKey(neighbor_depths);
+}
+
+void UChunkProvider::UpdateChunkLods()
+{
+	if (chunk_settings->lod_ring_width <= 0) return;
+
+	const FIntVector3 lod_center = GetLodCenter(chunk_grid.current_generator_pos);
+	if (lod_center == chunk_grid.lod_center) return;
+	chunk_grid.lod_center = lod_center;
+
+	const int32 load_dist = (chunk_grid.dim - 1) / 2;
+	auto in_area = [&](const FIntVector3& c)
 	{
-		FVector3f point_pos = FVector3f(x_pos[i], y_pos[i], z_pos[i]);
+		const FIntVector3 d = c - chunk_grid.current_generator_pos;
+		return FMath::Max3(FMath::Abs(d.X), FMath::Abs(d.Y), FMath::Abs(d.Z)) <= load_dist;
+	};
+
+	//chunks trailing the area already sit in the outermost ring and keep their depth until they are evicted.
+	//neighbours of a chunk that changes depth snap their boundary against it, they are resampled as well
+	TSet<FIntVector3> rebuild_coords;
+	chunk_grid.ForEachChunk([&](const FIntVector3& c, Chunk& chunk)
+		{
+			if (!in_area(c) || chunk.cut_depth == GetChunkDepth(c)) return;
 
-		FVector3f local_pos = point_pos - (sdf_op.position * 0.01f);
+			for (int32 x = -1; x < 2; x++)
+			{
+				for (int32 y = -1; y < 2; y++)
+				{
+					for (int32 z = -1; z < 2; z++)
+					{
+						const FIntVector3 n = c + FIntVector3(x, y, z);
+						if (in_area(n) && chunk_grid.Contains(n)) rebuild_coords.Add(n);
+					}
+				}
+			}
+		});
+
+	//like ModifyOperation, untouched neighbours only re-stitch the strips reaching into resampled chunks
+	TSet<FIntVector3> restitch_coords;
+	for (const FIntVector3& c : rebuild_coords)
+	{
+		RebuildChunkLod(c);
+		MeshChunk(c, PolygonizeTaskArg::RebuildAllSeams);
+
+		for (int32 x = -1; x < 2; x++)
+		{
+			for (int32 y = -1; y < 2; y++)
+			{
+				for (int32 z = -1; z < 2; z++)
+				{
+					const FIntVector3 n = c + FIntVector3(x, y, z);
+					if (rebuild_coords.Contains(n)) continue;
+
+					Chunk* neighbor = chunk_grid.TryGet(n);
+					if (neighbor && neighbor->seam_groups) restitch_coords.Add(n);
+				}
+			}
+		}
+	}
+
+	for (const FIntVector3& c : restitch_coords)
+	{
+		MeshChunk(c, PolygonizeTaskArg::SeamsOnly);
+	}
+}
+
+bool UChunkProvider::RequeueDroppedCreations()
+{
+	if (chunk_grid.dropped_creations.IsEmpty()) return false;
+
+	const FIntVector3 camera_coord = GetChunkCoordinatesFromPosition(FVector3f(camera_pos));
+	const int32 load_dist = (chunk_grid.dim - 1) / 2;
+	auto in_reach = [load_dist](const FIntVector3& c, const FIntVector3& center)
+	{
+		const FIntVector3 d = c - center;
+		return FMath::Max3(FMath::Abs(d.X), FMath::Abs(d.Y), FMath::Abs(d.Z)) <= load_dist;
+	};
 
-		float sdf_val = 0.f;
-		switch (sdf_op.sdf_type)
+	//chunks that left the area are built by BuildSlabs if it comes back, those the camera is still away from wait for the generator to move
+	TSet<FIntVector3> requeue_coords;
+	for (auto it = chunk_grid.dropped_creations.CreateIterator(); it; ++it)
+	{
+		const FIntVector3 c = *it;
+		if (!in_reach(c, chunk_grid.current_generator_pos) || chunk_grid.Contains(c))
 		{
-		case SDFType::Box:
-			sdf_val = SDF::Box(local_pos, ((sdf_op.bounds_size * 0.5f) * 0.01f));
-			break;
-		case SDFType::Sphere:
-			sdf_val = SDF::Sphere(local_pos, (sdf_op.bounds_size.X*0.5f) * 0.01f);
-			break;
+			it.RemoveCurrent();
+			continue;
 		}
+		if (!in_reach(c, camera_coord)) continue;
+
+		requeue_coords.Add(c);
+		it.RemoveCurrent();
+	}
 
-		switch (sdf_op.mod_type)
+	//neighbours stitched their seam strips without the dropped chunks
+	TSet<FIntVector3> restitch_coords;
+	for (const FIntVector3& c : requeue_coords)
+	{
+		CreateChunk(c);
+		MeshChunk(c, PolygonizeTaskArg::RebuildAllSeams);
+
+		for (int32 x = -1; x < 2; x++)
 		{
-		case ModType::Subtract:
-			noise[i] = FMath::Max(noise[i], -sdf_val);
-			break;
-		case ModType::Union:
-			noise[i] = FMath::Min(noise[i], sdf_val);
-			break;
+			for (int32 y = -1; y < 2; y++)
+			{
+				for (int32 z = -1; z < 2; z++)
+				{
+					const FIntVector3 n = c + FIntVector3(x, y, z);
+					if (requeue_coords.Contains(n)) continue;
+
+					Chunk* neighbor = chunk_grid.TryGet(n);
+					if (neighbor && neighbor->seam_groups) restitch_coords.Add(n);
+				}
+			}
 		}
 	}
+
+	for (const FIntVector3& c : restitch_coords)
+	{
+		MeshChunk(c, PolygonizeTaskArg::SeamsOnly);
+	}
+
+	return !requeue_coords.IsEmpty();
 }
 
 void UChunkProvider::BuildSlabs(FIntVector3 delta, FIntVector3 current_chunk_coord)
@@ -330,7 +741,7 @@ void UChunkProvider::BuildSlabs(FIntVector3 delta, FIntVector3 current_chunk_coo
 
 	for (auto& t : build_coords)
 	{
-		if(chunk_grid.chunks.Contains(t.Key)) continue;
+		if(chunk_grid.Contains(t.Key)) continue;
 
 		CreateChunk(t.Key);
 		MeshChunk(t.Key, t.Value);
@@ -344,40 +755,73 @@ void UChunkProvider::MeshChunk(const FIntVector3& coords, PolygonizeTaskArg task
 
 void UChunkProvider::CreateChunk(FIntVector3 coord)
 {
-	checkSlow(!chunk_grid.chunks.Contains(coord));
-
-	auto info  = render_actor->FetchRMComponentInfo(chunk_settings->terrain_material.Get());
+	checkSlow(!chunk_grid.Contains(coord));
 
 	float size = chunk_settings->chunk_size;
 
+	//the mesh component is only fetched once the chunk turns out to have a surface, see DispatchPolygonizeTask
 	Chunk chunk;
 	chunk.center = FVector3f(coord.X * size + size * 0.5f, coord.Y * size + size * 0.5f, coord.Z * size + size * 0.5f);
-	chunk.mesh = info.mesh;
-	chunk.rmc_newly_created = !info.pooled;
-	chunk.has_section_built = info.has_section;
+	chunk.depth = GetChunkDepth(coord);
+	chunk.cut_depth = chunk.depth;
+
+	//the ring leaves room for every chunk still waiting on its ping deletion, anything older is evicted here
+	FIntVector3 occupant;
+	if (chunk_grid.GetSlotOccupant(coord, occupant))
+	{
+		EvictChunk(occupant);
+	}
+
+	//recently evicted chunks come back without any task
+	if (ReviveChunk(coord)) return;
 
-	chunk_grid.chunks.Add(coord, MoveTemp(chunk));
+	//the restore task looks the chunk up in the region cache and samples it like a new one if there is no usable record
+	const CreationTaskArg task_arg = region_cache.IsInitialized() ? CreationTaskArg::Restore : CreationTaskArg::NewlyCreated;
 
-	CreationTaskArg task_arg = info.pooled ? CreationTaskArg::NewlyCreated : CreationTaskArg::Update;
+	chunk_grid.Add(coord, MoveTemp(chunk));
 
 	//building octree job
-	chunk_grid.chunk_creation_jobs.Enqueue(MakeTuple(coord, task_arg));
+	chunk_grid.chunk_creation_jobs.Add(ChunkCreationJob{coord, task_arg});
+	chunk_grid.pending_creations.FindOrAdd(coord)++;
 }
 
-void UChunkProvider::RebuildChunk(FIntVector3 coord)
+void UChunkProvider::RebuildChunk(FIntVector3 coord, const FSDFOp& sdf_op)
 {
-	checkSlow(chunk_grid.chunks.Contains(coord));
+	checkSlow(chunk_grid.Contains(coord));
 
+	//the pointer octree is kept and only rebuilt around the edit, linear octrees and leaf grids are rebuilt as a whole
 	Chunk& chunk = chunk_grid.GetMutable(coord);
-	chunk.root.Reset();
+	chunk.linear_tree.Reset();
+	chunk.progressive_tree.Reset();
+	chunk.leaf_grid.Reset();
 
-	chunk_grid.chunk_creation_jobs.Enqueue(MakeTuple(coord, CreationTaskArg::ModifyOperation));
+	chunk_grid.chunk_creation_jobs.Add(ChunkCreationJob{coord, CreationTaskArg::ModifyOperation, sdf_op});
+	chunk_grid.pending_creations.FindOrAdd(coord)++;
+}
+
+void UChunkProvider::RebuildChunkLod(FIntVector3 coord)
+{
+	checkSlow(chunk_grid.Contains(coord));
+
+	//the old tree stays until the new one comes back, seams reaching the chunk wait on its creation
+	Chunk& chunk = chunk_grid.GetMutable(coord);
+	const int32 new_depth = GetChunkDepth(coord);
+	chunk.cut_depth = new_depth;
+
+	//the progressive tree holds every coarser depth already. its boundary stays valid as long as the neighbours it was snapped against kept their depths,
+	//depth is left at the sampled one so the recut task cuts it at new_depth. a pending creation replaces the tree, it is resampled behind it
+	const bool recut = new_depth <= chunk.depth && !chunk.progressive_tree.IsEmpty() && !chunk_grid.pending_creations.Contains(coord)
+		&& chunk.lod_key == GetChunkLodKey(coord, chunk.depth);
+	if (!recut) chunk.depth = new_depth;
+
+	chunk_grid.chunk_creation_jobs.Add(ChunkCreationJob{coord, recut ? CreationTaskArg::Recut : CreationTaskArg::LodChange});
+	chunk_grid.pending_creations.FindOrAdd(coord)++;
 }
 
 bool UChunkProvider::IsSafeToModifyChunks()
 {
-	bool tasks_empty = chunk_grid.chunk_creation_tasks.IsEmpty() && chunk_grid.chunk_polygonize_tasks.IsEmpty();
-	bool jobs_empty = chunk_grid.chunk_creation_jobs.IsEmpty() && chunk_grid.chunk_polygonize_jobs.IsEmpty();
+	bool tasks_empty = chunk_grid.creation_tasks_in_flight == 0 && chunk_grid.chunk_polygonize_tasks.IsEmpty();
+	bool jobs_empty = chunk_grid.chunk_creation_jobs.IsEmpty() && chunk_grid.chunk_polygonize_jobs.IsEmpty() && chunk_grid.polygonize_graph.IsEmpty() && chunk_grid.ready_polygonize_jobs.IsEmpty();
 	//bool sections_empty = chunk_grid.chunk_section_tasks.IsEmpty();
 
 	return tasks_empty && jobs_empty; //&& sections_empty;
@@ -389,25 +833,25 @@ void UChunkProvider::FillSeamOctreeNodes(TArray<OctreeNode*, TInlineAllocator<8>
 	{
 		//main node 0
 		Chunk* chunk_1 = chunk_grid.TryGet(c + FIntVector3(1, 0, 0));
-		OctreeNode* octant_1 = chunk_1 ? chunk_1->root.Get() : nullptr;
+		OctreeNode* octant_1 = chunk_1 ? chunk_1->root : nullptr;
 
 		Chunk* chunk_2 = chunk_grid.TryGet(c + FIntVector3(0, 0, 1));
-		OctreeNode* octant_2 = chunk_2 ? chunk_2->root.Get() : nullptr;
+		OctreeNode* octant_2 = chunk_2 ? chunk_2->root : nullptr;
 
 		Chunk* chunk_3 = chunk_grid.TryGet(c + FIntVector3(1, 0, 1));
-		OctreeNode* octant_3 = chunk_3 ? chunk_3->root.Get() : nullptr;
+		OctreeNode* octant_3 = chunk_3 ? chunk_3->root : nullptr;
 
 		Chunk* chunk_4 = chunk_grid.TryGet(c + FIntVector3(0, 1, 0));
-		OctreeNode* octant_4 = chunk_4 ? chunk_4->root.Get() : nullptr;
+		OctreeNode* octant_4 = chunk_4 ? chunk_4->root : nullptr;
 
 		Chunk* chunk_5 = chunk_grid.TryGet(c + FIntVector3(1, 1, 0));
-		OctreeNode* octant_5 = chunk_5 ? chunk_5->root.Get() : nullptr;
+		OctreeNode* octant_5 = chunk_5 ? chunk_5->root : nullptr;
 
 		Chunk* chunk_6 = chunk_grid.TryGet(c + FIntVector3(0, 1, 1));
-		OctreeNode* octant_6 = chunk_6 ? chunk_6->root.Get() : nullptr;
+		OctreeNode* octant_6 = chunk_6 ? chunk_6->root : nullptr;
 
 		Chunk* chunk_7 = chunk_grid.TryGet(c + FIntVector3(1, 1, 1));
-		OctreeNode* octant_7 = chunk_7 ? chunk_7->root.Get() : nullptr;
+		OctreeNode* octant_7 = chunk_7 ? chunk_7->root : nullptr;
 
 		seam_octants[0] = root;
 		seam_octants[1] = octant_1;
@@ -423,25 +867,25 @@ void UChunkProvider::FillSeamOctreeNodes(TArray<OctreeNode*, TInlineAllocator<8>
 		//main node 7
 
 		Chunk* chunk_0 = chunk_grid.TryGet(c + FIntVector3(-1, -1, -1));
-		OctreeNode* octant_0 = chunk_0 ? chunk_0->root.Get() : nullptr;
+		OctreeNode* octant_0 = chunk_0 ? chunk_0->root : nullptr;
 
 		Chunk* chunk_1 = chunk_grid.TryGet(c + FIntVector3(0, -1, -1));
-		OctreeNode* octant_1 = chunk_1 ? chunk_1->root.Get() : nullptr;
+		OctreeNode* octant_1 = chunk_1 ? chunk_1->root : nullptr;
 
 		Chunk* chunk_2 = chunk_grid.TryGet(c + FIntVector3(-1, -1, 0));
-		OctreeNode* octant_2 = chunk_2 ? chunk_2->root.Get() : nullptr;
+		OctreeNode* octant_2 = chunk_2 ? chunk_2->root : nullptr;
 
 		Chunk* chunk_3 = chunk_grid.TryGet(c + FIntVector3(0, -1, 0));
-		OctreeNode* octant_3 = chunk_3 ? chunk_3->root.Get() : nullptr;
+		OctreeNode* octant_3 = chunk_3 ? chunk_3->root : nullptr;
 
 		Chunk* chunk_4 = chunk_grid.TryGet(c + FIntVector3(-1, 0, -1));
-		OctreeNode* octant_4 = chunk_4 ? chunk_4->root.Get() : nullptr;
+		OctreeNode* octant_4 = chunk_4 ? chunk_4->root : nullptr;
 
 		Chunk* chunk_5 = chunk_grid.TryGet(c + FIntVector3(0, 0, -1));
-		OctreeNode* octant_5 = chunk_5 ? chunk_5->root.Get() : nullptr;
+		OctreeNode* octant_5 = chunk_5 ? chunk_5->root : nullptr;
 
 		Chunk* chunk_6 = chunk_grid.TryGet(c + FIntVector3(-1, 0, 0));
-		OctreeNode* octant_6 = chunk_6 ? chunk_6->root.Get() : nullptr;
+		OctreeNode* octant_6 = chunk_6 ? chunk_6->root : nullptr;
 
 		seam_octants[0] = octant_0;
 		seam_octants[1] = octant_1;
@@ -454,281 +898,702 @@ void UChunkProvider::FillSeamOctreeNodes(TArray<OctreeNode*, TInlineAllocator<8>
 	}
 }
 
-void UChunkProvider::DrainChunkBuildQueues()
+void UChunkProvider::FillSeamOctreeNodes(TArray<const LinearOctree*, TInlineAllocator<8>>& seam_trees, bool negative_delta, const FIntVector3& c, const LinearOctree* tree)
+{
+	//same ordering as the pointer version above, octant i sits at offset (x = bit 0, y = bit 2, z = bit 1), shifted back by one for the positive delta case
+	for (int32 i = 0; i < 8; i++)
+	{
+		FIntVector3 offset = FIntVector3(i & 1, (i >> 2) & 1, (i >> 1) & 1);
+		if (!negative_delta) offset -= FIntVector3(1, 1, 1);
+
+		if (offset == FIntVector3::ZeroValue)
+		{
+			seam_trees[i] = tree;
+			continue;
+		}
+
+		Chunk* neighbor = chunk_grid.TryGet(c + offset);
+		seam_trees[i] = neighbor && !neighbor->linear_tree.IsEmpty() ? &neighbor->linear_tree : nullptr;
+	}
+}
+
+void UChunkProvider::FillSeamOctreeNodes(TArray<const UniformLeafGrid*, TInlineAllocator<8>>& seam_grids, bool negative_delta, const FIntVector3& c, const UniformLeafGrid* grid)
+{
+	for (int32 i = 0; i < 8; i++)
+	{
+		FIntVector3 offset = FIntVector3(i & 1, (i >> 2) & 1, (i >> 1) & 1);
+		if (!negative_delta) offset -= FIntVector3(1, 1, 1);
+
+		if (offset == FIntVector3::ZeroValue)
+		{
+			seam_grids[i] = grid;
+			continue;
+		}
+
+		Chunk* neighbor = chunk_grid.TryGet(c + offset);
+		seam_grids[i] = neighbor && !neighbor->leaf_grid.IsEmpty() ? &neighbor->leaf_grid : nullptr;
+	}
+}
+
+static FRealtimeMeshSectionGroupKey GetInteriorGroupKey()
+{
+	return FRealtimeMeshSectionGroupKey::Create(0, FName("DC_Mesh"));
+}
+
+//negative_delta stitches towards the positive neighbours
+static FRealtimeMeshSectionGroupKey GetSeamGroupKey(bool negative_delta)
+{
+	return FRealtimeMeshSectionGroupKey::Create(0, negative_delta ? FName("DC_SeamPositive") : FName("DC_SeamNegative"));
+}
+
+//CreateSectionGroup creates or updates, strips without triangles drop their group. returns whether anything was uploaded
+static bool UploadSectionGroup(URealtimeMeshSimple* mesh, const FRealtimeMeshSectionGroupKey& group_key, RealtimeMesh::FRealtimeMeshStreamSet&& stream_set, const FRealtimeMeshSectionGroupConfig& config, ChunkPolygonizeResult& result)
+{
+	const RealtimeMesh::FRealtimeMeshStream* triangles = stream_set.Find(RealtimeMesh::FRealtimeMeshStreams::Triangles);
+	if (!triangles || triangles->Num() == 0)
+	{
+		result.mesh_futures.Add(mesh->RemoveSectionGroup(group_key));
+		return false;
+	}
+
+	result.mesh_futures.Add(mesh->CreateSectionGroup(group_key, MoveTemp(stream_set), config));
+
+	FRealtimeMeshSectionKey section_key = FRealtimeMeshSectionKey::Create(group_key, FName("Section_PolyGroup"));
+	result.collision_futures.Add(mesh->UpdateSectionConfig(section_key, FRealtimeMeshSectionConfig(), true));
+
+	return true;
+}
+
+void UChunkProvider::DispatchPolygonizeTask(const FIntVector3& coord, PolygonizeTaskArg task_arg)
+{
+	Chunk& chunk = chunk_grid.GetMutable(coord);
+
+	if(chunk.HasSurface())
+	{
+		if (!chunk.mesh)
+		{
+			auto info = render_actor->FetchRMComponentInfo(chunk_settings->terrain_material.Get());
+			chunk.mesh = info.mesh;
+			chunk.rmc_newly_created = !info.pooled;
+			chunk.has_section_built = info.has_section;
+		}
+
+		bool edge_case = false;
+		if (task_arg != PolygonizeTaskArg::Area && task_arg != PolygonizeTaskArg::SeamsOnly)
+		{
+			if (task_arg == PolygonizeTaskArg::RebuildAllSeams) edge_case = true;
+			else if (task_arg == PolygonizeTaskArg::SlabNegative)
+			{
+				Chunk* back;
+				Chunk* down;
+				Chunk* left;
+
+				if (temp_created_chunks.Contains(coord + FIntVector3(-1, 0, 0)))
+				{
+					back = nullptr;
+				}
+				else
+				{
+					back = chunk_grid.TryGet(coord + FIntVector3(-1, 0, 0));
+				}
+
+				if (temp_created_chunks.Contains(coord + FIntVector3(0, 0, -1)))
+				{
+					down = nullptr;
+				}
+				else
+				{
+					down = chunk_grid.TryGet(coord + FIntVector3(0, 0, -1));
+				}
+
+				if (temp_created_chunks.Contains(coord + FIntVector3(0, -1, 0)))
+				{
+					left = nullptr;
+				}
+				else
+				{
+					left = chunk_grid.TryGet(coord + FIntVector3(0, -1, 0));
+				}
+
+				edge_case = back || down || left;
+			}
+			else
+			{
+				Chunk* front;
+				Chunk* up;
+				Chunk* right;
+
+				if (temp_created_chunks.Contains(coord + FIntVector3(1, 0, 0)))
+				{
+					front = nullptr;
+				}
+				else
+				{
+					front = chunk_grid.TryGet(coord + FIntVector3(1, 0, 0));
+				}
+
+				if (temp_created_chunks.Contains(coord + FIntVector3(0, 0, 1)))
+				{
+					up = nullptr;
+				}
+				else
+				{
+					up = chunk_grid.TryGet(coord + FIntVector3(0, 0, 1));
+				}
+
+				if (temp_created_chunks.Contains(coord + FIntVector3(0, 1, 0)))
+				{
+					right = nullptr;
+				}
+				else
+				{
+					right = chunk_grid.TryGet(coord + FIntVector3(0, 1, 0));
+				}
+
+				edge_case = front || up || right;
+			}
+		}
+
+		bool negative_delta = (task_arg == PolygonizeTaskArg::SlabNegative);
+
+		//bit negative_delta set for every seam strip this task re-stitches
+		uint8 seam_mask = 0;
+		if (task_arg == PolygonizeTaskArg::SeamsOnly)
+		{
+			seam_mask = chunk.seam_groups;
+		}
+		else
+		{
+			seam_mask = (1 << negative_delta) | (edge_case ? (1 << !negative_delta) : 0);
+		}
+		chunk.seam_groups |= seam_mask;
+
+		//a task covering every strip the chunk owns can tell the chunk has nothing left to show
+		const bool covers_all_groups = seam_mask == chunk.seam_groups;
+
+		//the interior is uploaded once per creation, seam only tasks leave it alone
+		const bool upload_interior = chunk.interior_pending;
+		RealtimeMesh::FRealtimeMeshStreamSet interior;
+		if (upload_interior)
+		{
+			//revived chunks upload the streams they kept, see ReviveChunk
+			if (chunk_settings->evicted_chunk_budget_mb > 0) interior.CopyFrom(chunk.interior_streams);
+			else interior = MoveTemp(chunk.interior_streams);
+			chunk.interior_pending = false;
+		}
+
+		//every chunk is in the same mode, settings changes rebuild all of them
+		OctreeNode* root = chunk.root;
+		const bool grid = !chunk.leaf_grid.IsEmpty();
+		const bool linear = !root && !grid;
+
+		TArray<OctreeNode*, TInlineAllocator<8>> seam_octants[2];
+		TArray<const LinearOctree*, TInlineAllocator<8>> seam_trees[2];
+		TArray<const UniformLeafGrid*, TInlineAllocator<8>> seam_grids[2];
+
+		for (int32 nd = 0; nd < 2; nd++)
+		{
+			if (!((seam_mask >> nd) & 1)) continue;
+
+			if (grid)
+			{
+				seam_grids[nd].SetNumUninitialized(8);
+				FillSeamOctreeNodes(seam_grids[nd], nd, coord, &chunk.leaf_grid);
+			}
+			else if (linear)
+			{
+				seam_trees[nd].SetNumUninitialized(8);
+				FillSeamOctreeNodes(seam_trees[nd], nd, coord, &chunk.linear_tree);
+			}
+			else
+			{
+				seam_octants[nd].SetNumUninitialized(8);
+				FillSeamOctreeNodes(seam_octants[nd], nd, coord, root);
+			}
+		}
+
+		URealtimeMeshSimple* chunk_mesh = chunk.mesh;
+
+		chunk_grid.chunk_polygonize_tasks.Add(AsyncPool(*thread_pool,
+			[coord, seam_mask, covers_all_groups, upload_interior, interior = MoveTemp(interior), linear, grid, seam_octants, seam_trees, seam_grids, chunk_mesh]() mutable -> ChunkPolygonizeResult
+			{
+				ChunkPolygonizeResult result;
+				result.chunk_coord = coord;
+
+				bool has_triangles = false;
+
+				if (upload_interior)
+				{
+					has_triangles |= UploadSectionGroup(chunk_mesh, GetInteriorGroupKey(), MoveTemp(interior), FRealtimeMeshSectionGroupConfig(), result);
+				}
+
+				//seam strips are rebuilt whenever a neighbour changes, keep them out of the static interior
+				FRealtimeMeshSectionGroupConfig seam_config;
+				seam_config.DrawType = ERealtimeMeshSectionDrawType::Dynamic;
+
+				for (int32 nd = 0; nd < 2; nd++)
+				{
+					if (!((seam_mask >> nd) & 1)) continue;
+
+					RealtimeMesh::FRealtimeMeshStreamSet stream_set;
+					if (grid)
+					{
+						stream_set = UOctreeCode::PolygonizeSeam(seam_grids[nd], nd);
+					}
+					else if (linear)
+					{
+						stream_set = UOctreeCode::PolygonizeSeam(seam_trees[nd], nd);
+					}
+					else
+					{
+						stream_set = UOctreeCode::PolygonizeSeam(seam_octants[nd], nd);
+					}
+
+					has_triangles |= UploadSectionGroup(chunk_mesh, GetSeamGroupKey(nd), MoveTemp(stream_set), seam_config, result);
+				}
+
+				result.rm_aborted = upload_interior && covers_all_groups && !has_triangles;
+
+				return result;
+			}));
+
+	}
+	else 
+	{
+		chunk.has_section_built = false;
+		ReleaseChunkMesh(chunk);
+	}
+}
+
+void UChunkProvider::DispatchCreationTask(const ChunkCreationJob& job)
+{
+	Chunk& chunk = chunk_grid.GetMutable(job.chunk_coord);
+
+	FVector3f chunk_center = chunk.center;
+
+	OctreeSettingsMultithreadContext settings_context;
+	settings_context = *GetDefault<UOctreeSettings>();
+
+	float size = chunk_settings->chunk_size;
+
+	CreationTaskArg task_arg = job.task_arg;
+
+	chunk_grid.creation_tasks_in_flight++;
+
+	const NoiseFieldStorage storage = chunk_settings->noise_field_storage;
+	const float storage_range = chunk_settings->noise_field_range;
+	const bool keep_hermite = chunk_settings->keep_hermite_data;
+
+	//every chunk is sampled and built at its own lod depth, its boundary snapped against coarser neighbours
+	const bool lod = chunk_settings->lod_ring_width > 0;
+	settings_context.max_depth = chunk.depth;
+
+	TStaticArray<int32, 27> neighbor_depths;
+	uint32 lod_key = 0;
+	if (lod)
+	{
+		GetNeighborDepths(job.chunk_coord, neighbor_depths);
+		//the rings may have moved since the job was queued, the field is sampled at the chunk's own depth
+		neighbor_depths[13] = chunk.depth;
+		lod_key = GetLodKey(neighbor_depths);
+
+		//grid seams walk matching voxel rows, neighbours of another depth need the octree seams
+		settings_context.uniform_leaf_grid = false;
+	}
+
+	//recuts and rederives keep the noise field and with it the boundary it was snapped to
+	if (task_arg != CreationTaskArg::Recut && task_arg != CreationTaskArg::Rederive) chunk.lod_key = lod_key;
+
+	//progressive octrees are built at the depth the chunk was sampled at and cut at its current one
+	const int32 depth_cut = FMath::Min(chunk.depth, GetChunkDepth(job.chunk_coord));
+
+	if (task_arg == CreationTaskArg::Recut)
+	{
+		AsyncPool(*thread_pool, [this, coord = job.chunk_coord, settings_context, depth_cut, &progressive_tree = chunk.progressive_tree]()
+			{
+				ChunkCreationResult result;
+				result.chunk_coord = coord;
+				result.recut = true;
+
+				UOctreeCode::ExtractOctree(progressive_tree, settings_context, depth_cut, result.created_linear_tree);
+				PolygonizeChunkInterior(result);
+				result.chunk_update = true;
+
+				chunk_grid.chunk_creation_results.Enqueue(MoveTemp(result));
+			});
+	}
+	else if (task_arg == CreationTaskArg::Rederive)
+	{
+		//the task looks the old edges up while building, the chunk gets the new ones with the result
+		HermiteData hermite = MoveTemp(chunk.hermite);
+
+		//every loaded chunk is rederived at once, like creations
+		settings_context.parallel_octant_build = false;
+
+		AsyncPool(*thread_pool, [this, coord = job.chunk_coord, chunk_center, size, settings_context, depth_cut, keep_hermite, hermite = MoveTemp(hermite), &stored_noise_field = chunk.noise_field, &sdf_ops = chunk.sdf_ops]() mutable
+			{
+				ChunkCreationResult result;
+				result.chunk_coord = coord;
+				result.rederived = true;
+
+				//edits and lod snapping are part of the stored field already
+				TArray<float> noise_field;
+				stored_noise_field.Decode(noise_field);
+
+				BuildChunkTree(result, chunk_center, size, settings_context, noise_field, sdf_ops.IsEmpty() ? nullptr : &sdf_ops, depth_cut, &hermite);
+				PolygonizeChunkInterior(result);
+				if (keep_hermite) result.hermite = MoveTemp(hermite);
+				result.chunk_update = true;
+
+				chunk_grid.chunk_creation_results.Enqueue(MoveTemp(result));
+			});
+	}
+	else if (task_arg == CreationTaskArg::Restore)
+	{
+		settings_context.parallel_octant_build = false;
+
+		AsyncPool(*thread_pool, [this, coord = job.chunk_coord, chunk_center, size, settings_context, storage, storage_range, lod, neighbor_depths, lod_key, depth_cut, keep_hermite, noise_hash = built_noise_hash]() mutable
+			{
+				ChunkCacheRecord record;
+				const bool cached = region_cache.Read(coord, record) && record.header.noise_hash == noise_hash && record.header.depth == settings_context.max_depth && record.header.lod_key == lod_key;
+
+				ChunkCreationResult result;
+				result.chunk_coord = coord;
+
+				//normals sampled with another fdm offset or gradient mode are sampled again
+				const bool hermite_valid = record.header.hermite_hash == GetCacheHermiteHash(settings_context);
+
+				TArray<float> noise_field;
+				HermiteData hermite;
+				result.restored = cached && ChunkRegionCache::DecodePayload(record, result.noise_field, result.sdf_ops, hermite);
+				if (result.restored)
+				{
+					result.noise_field.Decode(noise_field);
+					if (!hermite_valid) hermite.Reset();
+				}
+				else
+				{
+					//sampled like a new chunk, whatever edits an unreadable record held are lost
+					if (cached) UE_LOG(LogTemp, Warning, TEXT("DC region cache: record of chunk %s is unreadable, sampling it again"), *coord.ToString());
+					result.noise_field.Reset();
+					result.sdf_ops.Empty();
+					hermite.Reset();
+
+					const int32 dim = UOctreeCode::GetDim(settings_context.max_depth) + 1;
+					noise_field.SetNumUninitialized(dim * dim * dim);
+					BuildNoiseField(noise_field, coord, FIntVector3(0), FIntVector3(dim - 1), settings_context.max_depth, settings_context.seed);
+					if (lod) SnapNoiseFieldBoundaries(noise_field, settings_context.max_depth, neighbor_depths);
+				}
+
+				BuildChunkTree(result, chunk_center, size, settings_context, noise_field, result.sdf_ops.IsEmpty() ? nullptr : &result.sdf_ops, depth_cut, &hermite);
+				PolygonizeChunkInterior(result);
+				if (!result.restored) result.noise_field.Encode(MoveTemp(noise_field), storage, settings_context.iso_surface, storage_range);
+				if (keep_hermite) result.hermite = MoveTemp(hermite);
+				result.chunk_update = false;
+
+				chunk_grid.chunk_creation_results.Enqueue(MoveTemp(result));
+			});
+	}
+	else if (task_arg == CreationTaskArg::ModifyOperation)
+	{
+		const FSDFOp& op = job.sdf_op;
+
+		chunk.sdf_ops.Add(op);
+
+		//the task owns the tree while it edits it, it comes back with the result
+		OctreeNode* root = chunk.root;
+		OctreeNodeArena node_arena = MoveTemp(chunk.node_arena);
+		chunk.root = nullptr;
+		HermiteData hermite = MoveTemp(chunk.hermite);
+
+		AsyncPool(*thread_pool, [this, coord = job.chunk_coord, chunk_center, size, settings_context, op, storage, storage_range, root, node_arena = MoveTemp(node_arena), hermite = MoveTemp(hermite), lod, neighbor_depths, depth_cut, keep_hermite, &stored_noise_field = chunk.noise_field, &sdf_ops = chunk.sdf_ops]() mutable
+			{
+				ChunkCreationResult result;
+				result.chunk_coord = coord;
+				//edges around the edit are stale, only the region rebuild knows which ones
+				if (keep_hermite) result.hermite = MoveTemp(hermite);
+
+				TArray<float> noise_field;
+				stored_noise_field.Decode(noise_field);
+
+				EditNoiseField(noise_field, chunk_center, size, settings_context.max_depth, op);
+
+				//snapped samples interpolate across the coarse lattice cells the edit touched, the region grows by one of them
+				FBox3f region = op.GetInfluenceBounds();
+				if (lod)
+				{
+					SnapNoiseFieldBoundaries(noise_field, settings_context.max_depth, neighbor_depths);
+
+					int32 min_depth = settings_context.max_depth;
+					for (int32 neighbor_depth : neighbor_depths) min_depth = FMath::Min(min_depth, neighbor_depth);
+					region = region.ExpandBy(size / UOctreeCode::GetDim(min_depth));
+				}
+
+				HermiteData* result_hermite = keep_hermite ? &result.hermite : nullptr;
+				if (settings_context.progressive_octree)
+				{
+					result.hermite.Reset();
+					UOctreeCode::BuildProgressiveOctree(chunk_center, size, settings_context, noise_field, &sdf_ops, result.created_progressive_tree, result_hermite);
+					UOctreeCode::ExtractOctree(result.created_progressive_tree, settings_context, depth_cut, result.created_linear_tree);
+				}
+				else if (settings_context.uniform_leaf_grid && !settings_context.simplify)
+				{
+					result.hermite.Reset();
+					UOctreeCode::BuildUniformLeafGrid(chunk_center, size, settings_context, noise_field, &sdf_ops, result.created_leaf_grid, result_hermite);
+				}
+				else if (settings_context.linear_octree)
+				{
+					result.hermite.Reset();
+					UOctreeCode::RebuildOctree(chunk_center, size, settings_context, noise_field, sdf_ops, result.created_linear_tree, result_hermite);
+				}
+				else
+				{
+					//edges outside of the rebuilt cells are kept as they are
+					result.created_root = UOctreeCode::RebuildOctreeRegion(root, chunk_center, size, settings_context, noise_field, sdf_ops, region, node_arena, result_hermite);
+					result.node_arena = MoveTemp(node_arena);
+				}
+				PolygonizeChunkInterior(result);
+				result.noise_field.Encode(MoveTemp(noise_field), storage, settings_context.iso_surface, storage_range);
+				result.chunk_update = true;
+
+				chunk_grid.chunk_creation_results.Enqueue(MoveTemp(result));
+			});
+	}
+	else
+	{
+		const int32 dim = UOctreeCode::GetDim(settings_context.max_depth) + 1;
+
+		TArray<float> noise_field;
+		noise_field.SetNumUninitialized(dim * dim * dim);
+
+		FIntVector3 sample_min, sample_max;
+		CopyNoiseFieldBoundaries(job.chunk_coord, dim, noise_field, sample_min, sample_max);
+
+		//creation tasks already keep every worker busy, only edits split their chunk into octants
+		settings_context.parallel_octant_build = false;
+
+		//lod changes resample an existing chunk, its edits are applied to the new field again
+		TArray<FSDFOp> sdf_ops;
+		if (task_arg == CreationTaskArg::LodChange) sdf_ops = chunk.sdf_ops;
+
+		AsyncPool(*thread_pool, [this, coord = job.chunk_coord, chunk_center, size, settings_context, storage, storage_range, noise_field = MoveTemp(noise_field), sample_min, sample_max, lod, neighbor_depths, depth_cut, keep_hermite, sdf_ops = MoveTemp(sdf_ops)]() mutable
+			{
+				ChunkCreationResult result;
+				result.chunk_coord = coord;
+
+				BuildNoiseField(noise_field, coord, sample_min, sample_max, settings_context.max_depth, settings_context.seed);
+				for (const FSDFOp& op : sdf_ops)
+				{
+					EditNoiseField(noise_field, chunk_center, size, settings_context.max_depth, op);
+				}
+				if (lod) SnapNoiseFieldBoundaries(noise_field, settings_context.max_depth, neighbor_depths);
+
+				BuildChunkTree(result, chunk_center, size, settings_context, noise_field, sdf_ops.IsEmpty() ? nullptr : &sdf_ops, depth_cut, keep_hermite ? &result.hermite : nullptr);
+				PolygonizeChunkInterior(result);
+				result.noise_field.Encode(MoveTemp(noise_field), storage, settings_context.iso_surface, storage_range);
+				result.chunk_update = false;
+
+				chunk_grid.chunk_creation_results.Enqueue(MoveTemp(result));
+			});
+	}
+}
+
+void UChunkProvider::ResolveCreationDependency(const FIntVector3& coord)
 {
-	const uint32 per_frame_polygonize_dispatch_count = 10;
-	uint32 dispatch_counter = 0;
-
-	//latent creation and polygonization
-	while (!chunk_grid.chunk_creation_jobs.IsEmpty())
-	{
-		TTuple<FIntVector, CreationTaskArg> tuple;
-		chunk_grid.chunk_creation_jobs.Dequeue(tuple);
+	int32& pending = chunk_grid.pending_creations.FindChecked(coord);
+	if (--pending > 0) return;
+	chunk_grid.pending_creations.Remove(coord);
 
-		Chunk& chunk = chunk_grid.GetMutable(tuple.Key);
+	TArray<int32, TInlineAllocator<8>> dependents;
+	if (!chunk_grid.creation_dependents.RemoveAndCopyValue(coord, dependents)) return;
 
-		FVector3f chunk_center = chunk.center;
+	for (int32 node_idx : dependents)
+	{
+		PolygonizeJobNode& node = chunk_grid.polygonize_graph[node_idx];
+		if (--node.pending_dependencies > 0) continue;
 
-		OctreeSettingsMultithreadContext settings_context;
-		settings_context = *GetDefault<UOctreeSettings>();
+		chunk_grid.ready_polygonize_jobs.Add(node);
+		chunk_grid.polygonize_graph.RemoveAt(node_idx);
+	}
+}
 
-		float size = chunk_settings->chunk_size;
+float UChunkProvider::GetJobPriority(const FIntVector3& coord, const FIntVector3& camera_coord, int32 load_dist) const
+{
+	const FIntVector3 d = coord - camera_coord;
+	//out of the load radius, only runs once nothing in range is left
+	if (FMath::Max3(FMath::Abs(d.X), FMath::Abs(d.Y), FMath::Abs(d.Z)) > load_dist) return TNumericLimits<float>::Max();
 
-		CreationTaskArg task_arg = tuple.Value;
+	const float size = chunk_settings->chunk_size;
+	const FVector chunk_center = (FVector(coord) + 0.5) * size;
+	const FVector to_chunk = chunk_center - camera_pos;
+	const float dist = to_chunk.Size();
 
-		if (task_arg == CreationTaskArg::ModifyOperation)
-		{
-			FSDFOp op;
-			chunk_grid.modify_operations.Dequeue(op);
+	float priority = dist;
 
-			chunk_grid.GetMutable(tuple.Key).sdf_ops.Add(op);
+	//cone test with the chunk's bounding sphere, the chunk around the camera always counts as visible
+	const float chunk_radius = size * UE_HALF_SQRT_3;
+	if (dist > chunk_radius)
+	{
+		const float half_angle = FMath::DegreesToRadians(chunk_settings->priority_view_cone_angle * 0.5f);
+		const float angle = FMath::Acos(FMath::Clamp(FVector::DotProduct(to_chunk / dist, camera_forward), -1.0, 1.0));
 
-			chunk_grid.chunk_creation_tasks.Add(AsyncPool(*thread_pool, [this, coord = tuple.Key, chunk_center, size, settings_context, op, &noise_field = chunk.noise_field, &sdf_ops = chunk.sdf_ops]() -> ChunkCreationResult
-				{
-					ChunkCreationResult result;
-					result.chunk_coord = coord;
+		if (angle - FMath::Asin(chunk_radius / dist) > half_angle) priority *= chunk_settings->out_of_view_priority_scale;
+	}
 
-					EditNoiseField(noise_field, chunk_center, size, settings_context.max_depth, op);
+	return priority;
+}
 
-					result.created_root = UOctreeCode::RebuildOctree(chunk_center, size, settings_context, noise_field, sdf_ops);
-					result.chunk_update = true;
+void UChunkProvider::DrainChunkBuildQueues()
+{
+	const FIntVector3 camera_coord = GetChunkCoordinatesFromPosition(FVector3f(camera_pos));
+	const int32 load_dist = (chunk_grid.dim - 1) / 2;
+	const int32 max_tasks_in_flight = pool_thread_num * chunk_settings->jobs_in_flight_per_thread;
 
-					return result;
-				}));
-		}
-		else
-		{
-			chunk_grid.chunk_creation_tasks.Add(AsyncPool(*thread_pool, [this, coord = tuple.Key, chunk_center, size, settings_context]() -> ChunkCreationResult
-				{
-					ChunkCreationResult result;
-					result.chunk_coord = coord;
-					result.noise_field = BuildNoiseField(chunk_center, size, settings_context.max_depth, settings_context.seed);
-					result.created_root = UOctreeCode::BuildOctree(chunk_center, size, settings_context, result.noise_field);
-					result.chunk_update = false;
-
-					return result;
-				}));
-		}
-	}
-	for (int32 i = 0; i < chunk_grid.chunk_creation_tasks.Num(); i++)
+	//creations the camera already left are dropped before they run. edits and rebuilds of chunks that already hold a field, edits and a mesh always go through.
+	//the generator area only moves once the queues are drained, RequeueDroppedCreations builds them then if they are still in it
+	for (int32 i = 0; i < chunk_grid.chunk_creation_jobs.Num(); i++)
 	{
-		auto& result = chunk_grid.chunk_creation_tasks[i];
-		if (result.IsReady())
-		{
-			ChunkCreationResult creation_result = result.Consume();
+		const ChunkCreationJob& job = chunk_grid.chunk_creation_jobs[i];
+		if (job.task_arg == CreationTaskArg::ModifyOperation || job.task_arg == CreationTaskArg::LodChange || job.task_arg == CreationTaskArg::Recut || job.task_arg == CreationTaskArg::Rederive) continue;
 
-			Chunk& chunk = chunk_grid.GetMutable(creation_result.chunk_coord);
-			chunk.root = MoveTemp(creation_result.created_root);
-			//chunk.rmc_newly_created = creation_result.task_arg == CreationTaskArg::NewlyCreated;
+		const FIntVector3 d = job.chunk_coord - camera_coord;
+		if (FMath::Max3(FMath::Abs(d.X), FMath::Abs(d.Y), FMath::Abs(d.Z)) <= load_dist) continue;
 
-			if (!creation_result.chunk_update)
-			{
-				chunk.noise_field = MoveTemp(creation_result.noise_field);
-			}
+		const FIntVector3 coord = job.chunk_coord;
+		chunk_grid.chunk_creation_jobs.RemoveAtSwap(i);
+		i--;
 
-			temp_created_chunks.Add(creation_result.chunk_coord);
+		ReleaseChunkMesh(chunk_grid.GetMutable(coord));
+		chunk_grid.Remove(coord);
+		chunk_grid.dropped_creations.Add(coord);
 
-			chunk_grid.chunk_creation_tasks.RemoveAt(i);
-			i--;
-		}
+		ResolveCreationDependency(coord);
 	}
-	if (chunk_grid.chunk_creation_tasks.IsEmpty())
+
+	//polygonize jobs wait on the creation of their chunk and of every neighbour their seams can reach
+	while (!chunk_grid.chunk_polygonize_jobs.IsEmpty())
 	{
-		while (!chunk_grid.chunk_polygonize_jobs.IsEmpty() && dispatch_counter < per_frame_polygonize_dispatch_count)
-		{
-			TTuple<FIntVector3, PolygonizeTaskArg> tuple;
-			chunk_grid.chunk_polygonize_jobs.Dequeue(tuple);
+		TTuple<FIntVector3, PolygonizeTaskArg> tuple;
+		chunk_grid.chunk_polygonize_jobs.Dequeue(tuple);
 
-			Chunk& chunk = chunk_grid.GetMutable(tuple.Key);
-			FIntVector3 coord = tuple.Key;
-			PolygonizeTaskArg task_arg = tuple.Value;
+		PolygonizeJobNode node;
+		node.chunk_coord = tuple.Key;
+		node.task_arg = tuple.Value;
 
-			if(chunk.root.IsValid())
+		TArray<FIntVector3, TInlineAllocator<27>> dependencies;
+		for (int32 x = -1; x < 2; x++)
+		{
+			for (int32 y = -1; y < 2; y++)
 			{
-				bool edge_case = false;
-				if (task_arg != PolygonizeTaskArg::Area)
+				for (int32 z = -1; z < 2; z++)
 				{
-					if (task_arg == PolygonizeTaskArg::RebuildAllSeams) edge_case = true;
-					else if (task_arg == PolygonizeTaskArg::SlabNegative)
-					{
-						Chunk* back;
-						Chunk* down;
-						Chunk* left;
-
-						if (temp_created_chunks.Contains(coord + FIntVector3(-1, 0, 0)))
-						{
-							back = nullptr;
-						}
-						else
-						{
-							back = chunk_grid.TryGet(coord + FIntVector3(-1, 0, 0));
-						}
-
-						if (temp_created_chunks.Contains(coord + FIntVector3(0, 0, -1)))
-						{
-							down = nullptr;
-						}
-						else
-						{
-							down = chunk_grid.TryGet(coord + FIntVector3(0, 0, -1));
-						}
+					FIntVector3 dependency = tuple.Key + FIntVector3(x, y, z);
+					if (chunk_grid.pending_creations.Contains(dependency)) dependencies.Add(dependency);
+				}
+			}
+		}
 
-						if (temp_created_chunks.Contains(coord + FIntVector3(0, -1, 0)))
-						{
-							left = nullptr;
-						}
-						else
-						{
-							left = chunk_grid.TryGet(coord + FIntVector3(0, -1, 0));
-						}
+		if (dependencies.IsEmpty())
+		{
+			chunk_grid.ready_polygonize_jobs.Add(node);
+			continue;
+		}
 
-						edge_case = back || down || left;
-					}
-					else
-					{
-						Chunk* front;
-						Chunk* up;
-						Chunk* right;
+		node.pending_dependencies = dependencies.Num();
+		const int32 node_idx = chunk_grid.polygonize_graph.Add(node);
+		for (const FIntVector3& dependency : dependencies)
+		{
+			chunk_grid.creation_dependents.FindOrAdd(dependency).Add(node_idx);
+		}
+	}
 
-						if (temp_created_chunks.Contains(coord + FIntVector3(1, 0, 0)))
-						{
-							front = nullptr;
-						}
-						else
-						{
-							front = chunk_grid.TryGet(coord + FIntVector3(1, 0, 0));
-						}
+	ChunkCreationResult creation_result;
+	while (chunk_grid.chunk_creation_results.Dequeue(creation_result))
+	{
+		chunk_grid.creation_tasks_in_flight--;
 
-						if (temp_created_chunks.Contains(coord + FIntVector3(0, 0, 1)))
-						{
-							up = nullptr;
-						}
-						else
-						{
-							up = chunk_grid.TryGet(coord + FIntVector3(0, 0, 1));
-						}
+		const FIntVector3 coord = creation_result.chunk_coord;
 
-						if (temp_created_chunks.Contains(coord + FIntVector3(0, 1, 0)))
-						{
-							right = nullptr;
-						}
-						else
-						{
-							right = chunk_grid.TryGet(coord + FIntVector3(0, 1, 0));
-						}
+		Chunk& chunk = chunk_grid.GetMutable(coord);
+		//frees the previous tree of this chunk in one go
+		chunk.node_arena = MoveTemp(creation_result.node_arena);
+		chunk.root = creation_result.created_root;
+		chunk.linear_tree = MoveTemp(creation_result.created_linear_tree);
+		chunk.leaf_grid = MoveTemp(creation_result.created_leaf_grid);
+		chunk.interior_streams = MoveTemp(creation_result.created_interior);
+		chunk.interior_pending = true;
 
-						edge_case = front || up || right;
-					}
-				}
+		if (!creation_result.recut)
+		{
+			chunk.progressive_tree = MoveTemp(creation_result.created_progressive_tree);
+			chunk.hermite = MoveTemp(creation_result.hermite);
 
-				bool negative_delta = (task_arg == PolygonizeTaskArg::SlabNegative);
+			//edits decode the stored field and hand back a re-encoded copy, rederived chunks keep theirs
+			if (!creation_result.rederived) chunk.noise_field = MoveTemp(creation_result.noise_field);
+			if (creation_result.restored) chunk.sdf_ops = MoveTemp(creation_result.sdf_ops);
 
-				OctreeNode* root = chunk.root.Get();
-				bool rmc_newly_created = chunk.rmc_newly_created;
-				bool has_section_built = chunk.has_section_built;
+			//anything but a restore leaves the region cache behind
+			chunk.cache_clean = creation_result.restored;
+		}
 
-				TArray<OctreeNode*, TInlineAllocator<8>> seam_octants;
-				seam_octants.SetNumUninitialized(8);
-				FillSeamOctreeNodes(seam_octants, negative_delta, coord, root);
+		temp_created_chunks.Add(coord);
 
-				URealtimeMeshSimple* chunk_mesh = chunk.mesh;
+		ResolveCreationDependency(coord);
+	}
 
-				if (edge_case)
-				{
-					TArray<OctreeNode*, TInlineAllocator<8>> ec_seam_octants;
-					ec_seam_octants.SetNumUninitialized(8);
-					FillSeamOctreeNodes(ec_seam_octants, !negative_delta, coord, root);
+	//the pool only ever holds a few tasks per thread, everything else stays queued here and is re-ranked every tick
+	auto by_priority = [](const auto& a, const auto& b) { return a.priority < b.priority; };
 
-					chunk_grid.chunk_polygonize_tasks.Add(AsyncPool(*thread_pool,
-						[this, coord, negative_delta, seam_octants, ec_seam_octants, chunk_mesh, rmc_newly_created, has_section_built]() -> ChunkPolygonizeResult
-						{
-							ChunkPolygonizeResult result;
-							result.chunk_coord = coord;
+	for (ChunkCreationJob& job : chunk_grid.chunk_creation_jobs)
+	{
+		job.priority = GetJobPriority(job.chunk_coord, camera_coord, load_dist);
+	}
+	chunk_grid.chunk_creation_jobs.Heapify(by_priority);
 
-							FRealtimeMeshSectionGroupKey mesh_group_key = FRealtimeMeshSectionGroupKey::Create(0, FName("DC_Mesh"));
-							RealtimeMesh::FRealtimeMeshStreamSet stream_set;
+	TArray<ChunkCreationJob, TInlineAllocator<8>> waiting_restores;
+	while (!chunk_grid.chunk_creation_jobs.IsEmpty() && chunk_grid.creation_tasks_in_flight < max_tasks_in_flight)
+	{
+		ChunkCreationJob job;
+		chunk_grid.chunk_creation_jobs.HeapPop(job, by_priority, EAllowShrinking::No);
 
-							stream_set = UOctreeCode::PolygonizeOctree(seam_octants, ec_seam_octants, negative_delta);
-							FRealtimeMeshStreamKey key = stream_set.GetStreamKeys().Get(FSetElementId::FromInteger(0));
-							//create / update mesh section of chunk
-							int32 idx_num = stream_set.Find(key)->Num();
-							if (idx_num < 3)
-							{
-								result.rm_aborted = true;
-							}
-							else
-							{
-								if (rmc_newly_created || !has_section_built)
-								{
-									result.mesh_future = chunk_mesh->CreateSectionGroup(mesh_group_key, MoveTemp(stream_set));
-								}
-								else
-								{
-									result.mesh_future = chunk_mesh->UpdateSectionGroup(mesh_group_key, MoveTemp(stream_set));
-								}
-
-								FRealtimeMeshSectionKey section_key = FRealtimeMeshSectionKey::Create(mesh_group_key, FName("Section_PolyGroup"));
-								result.collision_future = chunk_mesh->UpdateSectionConfig(section_key, FRealtimeMeshSectionConfig(), true);
-							}
+		//the record of a chunk evicted a moment ago is still being compressed, the restore waits until it is handed to the region cache
+		if (job.task_arg == CreationTaskArg::Restore && pending_cache_writes.Contains(job.chunk_coord))
+		{
+			waiting_restores.Add(job);
+			continue;
+		}
 
-							return result;
-						}));
+		DispatchCreationTask(job);
+	}
+	for (const ChunkCreationJob& job : waiting_restores)
+	{
+		chunk_grid.chunk_creation_jobs.HeapPush(job, by_priority);
+	}
 
-				}
-				else
-				{
-					chunk_grid.chunk_polygonize_tasks.Add(AsyncPool(*thread_pool,
-						[this, coord, negative_delta, seam_octants, chunk_mesh, rmc_newly_created, has_section_built]() -> ChunkPolygonizeResult
-						{
-							ChunkPolygonizeResult result;
-							result.chunk_coord = coord;
+	for (int32 i = 0; i < chunk_grid.ready_polygonize_jobs.Num(); i++)
+	{
+		PolygonizeJobNode& job = chunk_grid.ready_polygonize_jobs[i];
 
-							FRealtimeMeshSectionGroupKey mesh_group_key = FRealtimeMeshSectionGroupKey::Create(0, FName("DC_Mesh"));
-							RealtimeMesh::FRealtimeMeshStreamSet stream_set;
+		//chunk was dropped before its creation ran
+		if (!chunk_grid.TryGet(job.chunk_coord))
+		{
+			chunk_grid.ready_polygonize_jobs.RemoveAtSwap(i);
+			i--;
+			continue;
+		}
 
-							stream_set = UOctreeCode::PolygonizeOctree(seam_octants, negative_delta);
-							FRealtimeMeshStreamKey key = stream_set.GetStreamKeys().Get(FSetElementId::FromInteger(1));
-							
-							int32 idx_num = stream_set.Find(key)->Num();
-							if(idx_num < 3) 
-							{
-								result.rm_aborted = true;
-							}
-							else 
-							{
-								//create / update mesh section of chunk
-								if (rmc_newly_created || !has_section_built)
-								{
-									FRealtimeMeshSectionGroupConfig config;
-									config.DrawType = ERealtimeMeshSectionDrawType::Dynamic;
-									result.mesh_future = chunk_mesh->CreateSectionGroup(mesh_group_key, MoveTemp(stream_set), config);
-								}
-								else
-								{
-									result.mesh_future = chunk_mesh->UpdateSectionGroup(mesh_group_key, MoveTemp(stream_set));
-								}
-
-
-								FRealtimeMeshSectionKey section_key = FRealtimeMeshSectionKey::Create(mesh_group_key, FName("Section_PolyGroup"));
-								result.collision_future = chunk_mesh->UpdateSectionConfig(section_key, FRealtimeMeshSectionConfig(), true);
+		job.priority = GetJobPriority(job.chunk_coord, camera_coord, load_dist);
+	}
+	chunk_grid.ready_polygonize_jobs.Heapify(by_priority);
 
-							}
-							
-							
-							
-							return result;
-						}));
-				}
+	while (!chunk_grid.ready_polygonize_jobs.IsEmpty() && chunk_grid.chunk_polygonize_tasks.Num() < max_tasks_in_flight)
+	{
+		PolygonizeJobNode job;
+		chunk_grid.ready_polygonize_jobs.HeapPop(job, by_priority, EAllowShrinking::No);
 
-				dispatch_counter++;
-			}
-			else 
-			{
-				chunk.has_section_built = false;
-				ReleaseChunkMesh(chunk);
-			}
-		}
+		DispatchPolygonizeTask(job.chunk_coord, job.task_arg);
 	}
+
 	for (int32 i = 0; i < chunk_grid.chunk_polygonize_tasks.Num(); i++)
 	{
 		auto& result = chunk_grid.chunk_polygonize_tasks[i];
@@ -745,11 +1610,8 @@ void UChunkProvider::DrainChunkBuildQueues()
 				chunk_grid.chunk_polygonize_tasks.RemoveAt(i);
 				i--;
 			}
-			else if(polygonize_result.collision_future.IsReady() && polygonize_result.mesh_future.IsReady())
+			else if(polygonize_result.IsReady())
 			{
-				result.GetMutable().collision_future.Consume();
-				ERealtimeMeshProxyUpdateStatus status = result.GetMutable().mesh_future.Consume();
-
 				result.Consume();
 
 				chunk_grid.chunk_polygonize_tasks.RemoveAt(i);
@@ -765,11 +1627,150 @@ void UChunkProvider::ReleaseChunkMesh(Chunk& chunk)
 	//if chunk mesh was already released
 	if(!chunk.mesh) return;
 
+	//pooled meshes go back empty, the next owner may never upload an interior over this one (seam only or aborted chunks)
+	chunk.mesh->RemoveSectionGroup(GetInteriorGroupKey());
+	for (int32 nd = 0; nd < 2; nd++)
+	{
+		if ((chunk.seam_groups >> nd) & 1) chunk.mesh->RemoveSectionGroup(GetSeamGroupKey(nd));
+	}
+	chunk.seam_groups = 0;
+	chunk.has_section_built = false;
+
 	auto rmc = static_cast<URealtimeMeshComponent*>(chunk.mesh->GetOuter());
 	render_actor->ReleaseRMC(rmc, chunk.has_section_built);
 	chunk.mesh = nullptr;
 }
 
+void UChunkProvider::CacheChunk(const FIntVector3& coord, Chunk& chunk)
+{
+	//a chunk whose creation never ran has nothing to store
+	if (!region_cache.IsInitialized() || chunk.cache_clean || chunk.noise_field.Num() == 0) return;
+
+	ChunkCacheRecord record;
+	record.header.noise_hash = built_noise_hash;
+	record.header.hermite_hash = GetCacheHermiteHash(built_settings);
+	record.header.lod_key = chunk.lod_key;
+	record.header.depth = chunk.depth;
+
+	pending_cache_writes.Add(coord);
+
+	AsyncPool(*thread_pool, [this, coord, record = MoveTemp(record), noise_field = MoveTemp(chunk.noise_field), sdf_ops = MoveTemp(chunk.sdf_ops), hermite = MoveTemp(chunk.hermite)]() mutable
+		{
+			ChunkRegionCache::EncodePayload(noise_field, sdf_ops, hermite, record);
+			cache_writes.Enqueue(MakeTuple(coord, MoveTemp(record)));
+		});
+}
+
+void UChunkProvider::CacheLoadedChunks()
+{
+	//evicted chunks are dropped even without a region cache, they would outlive the settings they were built with
+	TrimEvictedChunks(0);
+
+	if (!region_cache.IsInitialized()) return;
+
+	//chunks with a creation task are in the middle of an edit or rebuild, their record on disk stays
+	chunk_grid.ForEachChunk([&](const FIntVector3& c, Chunk& chunk)
+		{
+			if (!chunk_grid.pending_creations.Contains(c)) CacheChunk(c, chunk);
+		});
+
+	DrainCacheWrites(true);
+}
+
+void UChunkProvider::EvictChunk(const FIntVector3& coord)
+{
+	Chunk& chunk = chunk_grid.GetMutable(coord);
+	ReleaseChunkMesh(chunk);
+
+	const SIZE_T budget = static_cast<SIZE_T>(chunk_settings->evicted_chunk_budget_mb) * 1024 * 1024;
+	if (budget > 0)
+	{
+		const SIZE_T allocated_size = sizeof(EvictedChunk) + chunk.GetAllocatedSize();
+
+		EvictedChunk& evicted = evicted_chunks.Add(coord, EvictedChunk{MoveTemp(chunk), allocated_size});
+		evicted_lru.AddTail(coord);
+		evicted.lru_node = evicted_lru.GetTail();
+		evicted_bytes += allocated_size;
+
+		TrimEvictedChunks(budget);
+	}
+	else
+	{
+		CacheChunk(coord, chunk);
+	}
+
+	chunk_grid.Remove(coord);
+}
+
+bool UChunkProvider::ReviveChunk(const FIntVector3& coord)
+{
+	EvictedChunk* evicted = evicted_chunks.Find(coord);
+	if (!evicted) return false;
+
+	evicted_bytes -= evicted->allocated_size;
+	evicted_lru.RemoveNode(evicted->lru_node);
+
+	Chunk& chunk = chunk_grid.Add(coord, MoveTemp(evicted->chunk));
+	evicted_chunks.Remove(coord);
+
+	//the kept interior goes up again on a pooled mesh component, its seams are stitched by the polygonize job of the slab like for any new chunk
+	chunk.interior_pending = true;
+	temp_created_chunks.Add(coord);
+
+	//the lod rings moved on while it was away, it is resampled like UpdateChunkLods would
+	if (chunk.cut_depth != GetChunkDepth(coord) || chunk.lod_key != GetChunkLodKey(coord, chunk.depth)) RebuildChunkLod(coord);
+
+	return true;
+}
+
+void UChunkProvider::TrimEvictedChunks(SIZE_T budget)
+{
+	while (evicted_bytes > budget && evicted_lru.GetHead())
+	{
+		const FIntVector3 coord = evicted_lru.GetHead()->GetValue();
+		evicted_lru.RemoveNode(evicted_lru.GetHead());
+
+		EvictedChunk& evicted = evicted_chunks.FindChecked(coord);
+		CacheChunk(coord, evicted.chunk);
+		evicted_bytes -= evicted.allocated_size;
+		evicted_chunks.Remove(coord);
+	}
+}
+
+void UChunkProvider::DrainCacheWrites(bool wait)
+{
+	TTuple<FIntVector3, ChunkCacheRecord> write;
+	while (!pending_cache_writes.IsEmpty())
+	{
+		if (cache_writes.Dequeue(write))
+		{
+			pending_cache_writes.Remove(write.Key);
+			if (region_cache.IsInitialized()) region_cache.Write(write.Key, MoveTemp(write.Value));
+		}
+		else if (wait) FPlatformProcess::Yield();
+		else break;
+	}
+
+	//at most one flush task per region in flight, the game thread never touches the files
+	if (region_cache.IsInitialized()) region_cache.Flush();
+}
+
+uint32 UChunkProvider::GetCacheNoiseHash(const OctreeSettingsMultithreadContext& settings) const
+{
+	uint32 hash = GetTypeHash(settings.seed);
+	hash = HashCombine(hash, UNoiseDataGenerator::GetGeneratorHash());
+	hash = HashCombine(hash, GetTypeHash(settings.iso_surface));
+	hash = HashCombine(hash, GetTypeHash(chunk_settings->chunk_size));
+	hash = HashCombine(hash, GetTypeHash(static_cast<uint8>(chunk_settings->noise_field_storage)));
+	hash = HashCombine(hash, GetTypeHash(chunk_settings->noise_field_range));
+	return hash;
+}
+
+uint32 UChunkProvider::GetCacheHermiteHash(const OctreeSettingsMultithreadContext& settings)
+{
+	return HashCombine(GetTypeHash(settings.normal_fdm_offset), GetTypeHash(static_cast<uint8>(settings.analytic_gradients)));
+}
+
 FVector UChunkProvider::GetActiveCameraLocation()
 {
 	#if WITH_EDITOR
@@ -804,24 +1805,42 @@ FVector UChunkProvider::GetActiveCameraLocation()
 	#endif
 }
 
+FVector UChunkProvider::GetActiveCameraForward()
+{
+	#if WITH_EDITOR
+		if (GEditor->IsPlaySessionInProgress())
+		{
+			if (APlayerCameraManager* camera_manager = UGameplayStatics::GetPlayerCameraManager(GetWorld(), 0))
+			{
+				return camera_manager->GetCameraRotation().Vector();
+			}
+			else return FVector::ForwardVector;
+		}
+		else if(GCurrentLevelEditingViewportClient)
+		{
+			return GCurrentLevelEditingViewportClient->GetViewRotation().Vector();
+		}
+		else return FVector::ForwardVector;
+	#else 
+		if(APlayerCameraManager * camera_manager = UGameplayStatics::GetPlayerCameraManager(GetWorld(), 0))
+		{
+			return camera_manager->GetCameraRotation().Vector();
+		}
+		else return FVector::ForwardVector;
+	#endif
+}
+
 void UChunkProvider::ModifyOperation(const FSDFOp& sdf_operation)
 {
 	if(!IsSafeToModifyChunks()) return;
 
-	const float inflate_factor = 2.f;
-
 	FIntVector3 coord = GetChunkCoordinatesFromPosition(sdf_operation.position);
 
-	if(!chunk_grid.chunks.Contains(coord)) return;
+	if(!chunk_grid.Contains(coord)) return;
 	
-	chunk_grid.modify_operations.Enqueue(sdf_operation);
-
 	float chunk_size = chunk_settings->chunk_size;
 
-	FVector3f op_min = sdf_operation.position - ((sdf_operation.bounds_size * 0.5f) * inflate_factor);
-	FVector3f op_max = sdf_operation.position + ((sdf_operation.bounds_size * 0.5f) * inflate_factor);
-
-	UE::Math::TBox<float> op_bb(op_min, op_max);
+	UE::Math::TBox<float> op_bb = sdf_operation.GetInfluenceBounds();
 
 	bool on_seam = false;
 	for (int32 x = -1; x < 2; x++)
@@ -844,16 +1863,20 @@ void UChunkProvider::ModifyOperation(const FSDFOp& sdf_operation)
 					if(chunk_bb.Intersect(op_bb)) 
 					{
 						on_seam = true;
-						chunk_grid.modify_operations.Enqueue(sdf_operation);
-						RebuildChunk(neigbor_coord);
+						RebuildChunk(neigbor_coord, sdf_operation);
 						MeshChunk(neigbor_coord, PolygonizeTaskArg::RebuildAllSeams);
 					}
+					else if (neighbor->seam_groups)
+					{
+						//untouched neighbour, only its seam strips can reach into the edited chunk
+						MeshChunk(neigbor_coord, PolygonizeTaskArg::SeamsOnly);
+					}
 				}
 			}
 		}
 	}
 
-	RebuildChunk(coord);
+	RebuildChunk(coord, sdf_operation);
 	MeshChunk(coord, PolygonizeTaskArg::RebuildAllSeams);
 }
 
@@ -866,32 +1889,32 @@ void UChunkProvider::Tick(float DeltaTime)
 #endif
 
 	FVector cam_pos = GetActiveCameraLocation();
+	camera_pos = cam_pos;
+	camera_forward = GetActiveCameraForward();
 	FIntVector current_chunk_coord = GetChunkCoordinatesFromPosition(FVector3f(cam_pos));
 	chunk_grid.min_coord = current_chunk_coord - FIntVector3(chunk_grid.dim / 2);
 
 #if WITH_EDITOR
 	if(chunk_settings->draw_debug_chunks)
 	{
-		for (const auto& pair : chunk_grid.chunks)
+		chunk_grid.ForEachChunk([&](const FIntVector3& c, const Chunk& chunk)
 		{
-			FVector3f chunk_center = pair.Value.center;
-
-			FIntVector3 c = pair.Key;
+			FVector3f chunk_center = chunk.center;
 
 			int32 dist = FMath::Sqrt(static_cast<float>((c.X - current_chunk_coord.X)*(c.X-current_chunk_coord.X) + (c.Y - current_chunk_coord.Y) * (c.Y - current_chunk_coord.Y) + (c.Z - current_chunk_coord.Z) * (c.Z - current_chunk_coord.Z)));
 
-			if(dist > chunk_settings->chunk_draw_max_dist) continue; 
+			if(dist > chunk_settings->chunk_draw_max_dist) return; 
 
 			DrawDebugBox(GetWorld(), FVector(chunk_center), FVector(static_cast<float>(chunk_settings->chunk_size)*0.5f), FColor::White);
-		}
+		});
 		GEditor->AddOnScreenDebugMessage(144, 0.1f, FColor::White, current_chunk_coord.ToString());
 	}
 
 	if(chunk_settings->draw_octree) 
 	{
-		if(chunk_grid.chunks.Contains(current_chunk_coord))
+		if(chunk_grid.Contains(current_chunk_coord))
 		{
-			OctreeNode* node = chunk_grid.Get(current_chunk_coord).root.Get();
+			OctreeNode* node = chunk_grid.Get(current_chunk_coord).root;
 
 			octree_manager->DebugDrawOctree(GetWorld(), node, 0, chunk_settings->draw_leaves, chunk_settings->draw_simplified_leaves, chunk_settings->debug_draw_how_deep);
 		}
@@ -902,63 +1925,46 @@ void UChunkProvider::Tick(float DeltaTime)
 	if(chunk_settings->stop_chunk_loading) return;
 
 	DrainChunkBuildQueues();
+	DrainCacheWrites(false);
 
 	if(IsSafeToModifyChunks())
 	{
 		temp_created_chunks.Empty();
 
-		bool poll_lifetime = false;
-		if (build_initial_area)
+		//the generator waits for the rederive, lod changes would race the tasks reading the chunks' noise fields and progressive octrees
+		if (pending_invalidation != SettingsInvalidation::None)
+		{
+			//evicted chunks are not rederived, the region cache still takes their noise fields
+			TrimEvictedChunks(0);
+			RederiveChunks(pending_invalidation);
+			built_settings = *GetDefault<UOctreeSettings>();
+			pending_invalidation = SettingsInvalidation::None;
+		}
+		else if (build_initial_area)
 		{
+			chunk_grid.lod_center = GetLodCenter(current_chunk_coord);
 			BuildChunkArea(current_chunk_coord);
 			chunk_grid.current_generator_pos = current_chunk_coord;
 
 			build_initial_area = false;
 		}
+		else if (RequeueDroppedCreations())
+		{
+			//the generator moves on once they are built
+		}
 		else if(current_chunk_coord != chunk_grid.current_generator_pos)
 		{
 			FIntVector3 gen_delta = current_chunk_coord - chunk_grid.current_generator_pos;
 			FIntVector3 clamp = FIntVector3(FMath::Clamp(gen_delta.X, -1, 1), FMath::Clamp(gen_delta.Y, -1, 1), FMath::Clamp(gen_delta.Z, -1,1));
+			const FIntVector3 previous_generator_pos = chunk_grid.current_generator_pos;
 			chunk_grid.current_generator_pos += clamp;
 
-			BuildSlabs(clamp, chunk_grid.current_generator_pos);
-
-			poll_lifetime = true;
-		}
-
-		if(poll_lifetime)
-		{
-			//TSparseArray for coordinates that exist with big big worlds..?
-
-			TArray<FIntVector3> poll_chunks = GetChunkArea(chunk_grid.current_generator_pos);
-			for (int32 i = 0; i < poll_chunks.Num(); i++)
-			{
-				if (chunk_grid.chunks.Contains(poll_chunks[i]))
-				{
-					Chunk& chunk = chunk_grid.GetMutable(poll_chunks[i]);
-					chunk.ping_counter = 0;
-				}
-			}
-			
-			//ping lifetime of existing chunks
-			TArray<FIntVector3> cleanup_chunks;
-			for (auto& pair : chunk_grid.chunks)
-			{
-				Chunk& chunk = pair.Value;
-
-				if (chunk.ping_counter >= chunk_settings->chunk_ping_deletion_at)
-				{
-					ReleaseChunkMesh(chunk);
+			//before the slab is created, its chunks are already sampled at the new depths
+			UpdateChunkLods();
 
-					cleanup_chunks.Add(pair.Key);
-				}
-				else chunk.ping_counter++;
-			}
-			for (int32 i = 0; i < cleanup_chunks.Num(); i++)
-			{
-				chunk_grid.chunks.FindAndRemoveChecked(cleanup_chunks[i]);
-			}
+			BuildSlabs(clamp, chunk_grid.current_generator_pos);
 
+			EvictSlabs(clamp, previous_generator_pos);
 		}
 	}
 }
@@ -995,46 +2001,131 @@ bool UChunkProvider::IsTickableInEditor() const
 
 Chunk* UChunkProvider::ChunkGrid::TryGet(FIntVector3 c)
 {
-	return chunks.Find(c);
+	const int32 slot = GetSlot(c);
+	return slot_used[slot] && slot_coords[slot] == c ? &slots[slot] : nullptr;
 }
 
 const Chunk& UChunkProvider::ChunkGrid::Get(FIntVector3 c)
 {
-	return chunks.FindChecked(c);
+	return GetMutable(c);
 }
 
 Chunk& UChunkProvider::ChunkGrid::GetMutable(FIntVector3 c)
 {
-	return chunks.FindChecked(c);
+	const int32 slot = GetSlot(c);
+	check(slot_used[slot] && slot_coords[slot] == c);
+	return slots[slot];
+}
+
+bool UChunkProvider::ChunkGrid::Contains(FIntVector3 c) const
+{
+	const int32 slot = GetSlot(c);
+	return slot_used[slot] && slot_coords[slot] == c;
 }
 
-void UChunkProvider::ChunkGrid::Realloc(int32 new_load_distance)
+Chunk& UChunkProvider::ChunkGrid::Add(FIntVector3 c, Chunk&& chunk)
+{
+	const int32 slot = GetSlot(c);
+	checkSlow(!slot_used[slot]);
+
+	slots[slot] = MoveTemp(chunk);
+	slot_coords[slot] = c;
+	slot_used[slot] = true;
+	num_chunks++;
+
+	return slots[slot];
+}
+
+void UChunkProvider::ChunkGrid::Remove(FIntVector3 c)
+{
+	const int32 slot = GetSlot(c);
+	checkSlow(slot_used[slot] && slot_coords[slot] == c);
+
+	//frees the octree, noise field and ops of the chunk
+	slots[slot] = Chunk();
+	slot_used[slot] = false;
+	num_chunks--;
+}
+
+bool UChunkProvider::ChunkGrid::GetSlotOccupant(FIntVector3 c, FIntVector3& occupant) const
+{
+	const int32 slot = GetSlot(c);
+	if (!slot_used[slot] || slot_coords[slot] == c) return false;
+
+	occupant = slot_coords[slot];
+	return true;
+}
+
+void UChunkProvider::ChunkGrid::Realloc(int32 new_load_distance, int32 ping_deletion_at)
 {
 	dim = (new_load_distance*2)+1;
 
-	chunk_creation_tasks.Reserve(dim * dim * dim);
+	//area coordinates around the origin, closest first
+	area_offsets.Reset(dim * dim * dim);
+	for (int32 x = -new_load_distance; x < new_load_distance + 1; x++)
+	{
+		for (int32 y = -new_load_distance; y < new_load_distance + 1; y++)
+		{
+			for (int32 z = -new_load_distance; z < new_load_distance + 1; z++)
+			{
+				area_offsets.Add(FIntVector3(x, y, z));
+			}
+		}
+	}
+	area_offsets.Sort([](const FIntVector3& a, const FIntVector3& b)
+	{
+		int64 dist_a = static_cast<int64>(a.X) * a.X + static_cast<int64>(a.Y) * a.Y + static_cast<int64>(a.Z) * a.Z;
+		int64 dist_b = static_cast<int64>(b.X) * b.X + static_cast<int64>(b.Y) * b.Y + static_cast<int64>(b.Z) * b.Z;
+
+		return dist_a < dist_b;
+	});
+	//chunks trail the load area by at most ping_deletion_at + 1 on either side before they get deleted
+	ring_dim = dim + 2 * (ping_deletion_at + 1);
+
+	const int32 slot_num = ring_dim * ring_dim * ring_dim;
+	slots.Empty(slot_num);
+	slots.SetNum(slot_num);
+	slot_coords.SetNumZeroed(slot_num);
+	slot_used.Init(false, slot_num);
+	num_chunks = 0;
+
+	pending_creations.Reserve(dim * dim * dim);
+	creation_dependents.Reserve(dim * dim * dim);
 	chunk_polygonize_tasks.Reserve(dim * dim * dim);
 }
 
 void UChunkProvider::ChunkGrid::Cleanup()
 {
-	chunk_creation_jobs.Empty();
-	for (int32 i = 0; i < chunk_creation_tasks.Num(); i++)
+	ChunkCreationResult creation_result;
+	while (creation_tasks_in_flight > 0)
 	{
-		auto& future = chunk_creation_tasks[i];
-		auto result = future.Consume();
+		if (chunk_creation_results.Dequeue(creation_result)) creation_tasks_in_flight--;
+		else FPlatformProcess::Yield();
 	}
-	chunk_creation_tasks.Empty();
+	pending_creations.Empty();
+	chunk_creation_jobs.Empty();
 
 	chunk_polygonize_jobs.Empty();
+	polygonize_graph.Empty();
+	creation_dependents.Empty();
+	ready_polygonize_jobs.Empty();
 	for (int32 i = 0; i < chunk_polygonize_tasks.Num(); i++)
 	{
 		auto& future = chunk_polygonize_tasks[i];
 		auto result = future.Consume();
-		result.mesh_future.Wait();
-		result.collision_future.Wait();
+		for (auto& mesh_future : result.mesh_futures) mesh_future.Wait();
+		for (auto& collision_future : result.collision_futures) collision_future.Wait();
 	}
 	chunk_polygonize_tasks.Empty();
 
-	chunks.Empty();
+	for (TConstSetBitIterator<> it(slot_used); it; ++it)
+	{
+		slots[it.GetIndex()] = Chunk();
+	}
+	slot_used.Init(false, slot_used.Num());
+	num_chunks = 0;
+
+	left_slabs.Empty();
+	generator_steps = 0;
+	dropped_creations.Empty();
 }
\ No newline at end of file
@@ -0,0 +1,451 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DC_ChunkRegionCache.h"
+#include "DC_Chunk.h"
+#include "HAL/PlatformFileManager.h"
+#include "Async/Async.h"
+#include "Async/MappedFileHandle.h"
+#include "Misc/Compression.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+static void SerializeHeader(FArchive& ar, ChunkCacheHeader& header)
+{
+	ar << header.noise_hash;
+	ar << header.hermite_hash;
+	ar << header.lod_key;
+	ar << header.depth;
+	ar << header.raw_size;
+	ar << header.compressed_size;
+}
+
+ChunkRegionCache::~ChunkRegionCache()
+{
+	Reset();
+}
+
+void ChunkRegionCache::Init(const FString& new_directory, FQueuedThreadPool& pool)
+{
+	Reset();
+
+	directory = new_directory;
+	thread_pool = &pool;
+	FPlatformFileManager::Get().GetPlatformFile().CreateDirectoryTree(*directory);
+}
+
+void ChunkRegionCache::Reset()
+{
+	//shutting down, whatever is left is written right here. without reads running nothing else touches regions
+	for (TPair<FIntVector3, TUniquePtr<Region>>& pair : regions)
+	{
+		Region& region = *pair.Value;
+		if (region.flush.IsValid()) region.flush.Wait();
+		FlushRegion(pair.Key, region);
+	}
+	for (TPair<FIntVector3, TUniquePtr<Region>>& pair : regions)
+	{
+		UnmapRegion(*pair.Value);
+	}
+	regions.Empty();
+	directory.Empty();
+	thread_pool = nullptr;
+}
+
+bool ChunkRegionCache::Read(const FIntVector3& coord, ChunkCacheRecord& record)
+{
+	const FIntVector3 region_coord = GetRegionCoord(coord);
+	Region& region = FindOrAddRegion(region_coord);
+	region.last_used = ++use_counter;
+
+	const int32 record_idx = GetRecordIndex(coord);
+	{
+		FScopeLock records_scope(&region.records_lock);
+
+		const ChunkCacheRecord* held = region.pending_writes.Find(record_idx);
+		if (!held) held = region.flushing_writes.Find(record_idx);
+		if (held)
+		{
+			record = *held;
+			return true;
+		}
+	}
+
+	//a flush updates the table before it lets go of its records, a record missed above is in the table by now
+	FScopeLock file_scope(&region.file_lock);
+	LoadRegion(region_coord, region);
+
+	const TableEntry& entry = region.table[record_idx];
+	if (entry.size == 0) return false;
+
+	//the mapping only covers the file as it was when it was mapped, writes since then remap it
+	if (!region.mapped_region || region.mapped_region->GetMappedSize() < static_cast<int64>(entry.offset + entry.size))
+	{
+		if (!MapRegion(region_coord, region)) return false;
+	}
+
+	FMemoryReaderView ar(MakeMemoryView(region.mapped_region->GetMappedPtr() + entry.offset, entry.size));
+	SerializeHeader(ar, record.header);
+	if (ar.IsError() || record.header.compressed_size < 0 || record.header.compressed_size > ar.TotalSize() - ar.Tell()) return false;
+
+	record.payload.SetNumUninitialized(record.header.compressed_size);
+	ar.Serialize(record.payload.GetData(), record.header.compressed_size);
+
+	return !ar.IsError();
+}
+
+void ChunkRegionCache::Write(const FIntVector3& coord, ChunkCacheRecord&& record)
+{
+	Region& region = FindOrAddRegion(GetRegionCoord(coord));
+	region.last_used = ++use_counter;
+
+	FScopeLock records_scope(&region.records_lock);
+	region.pending_writes.Add(GetRecordIndex(coord), MoveTemp(record));
+}
+
+void ChunkRegionCache::Flush()
+{
+	//reads on the pool may add regions meanwhile
+	TArray<TPair<FIntVector3, Region*>> flush_regions;
+	{
+		FScopeLock regions_scope(&regions_lock);
+		flush_regions.Reserve(regions.Num());
+		for (TPair<FIntVector3, TUniquePtr<Region>>& pair : regions)
+		{
+			flush_regions.Emplace(pair.Key, pair.Value.Get());
+		}
+	}
+
+	for (const TPair<FIntVector3, Region*>& pair : flush_regions)
+	{
+		Region& region = *pair.Value;
+
+		//records handed over meanwhile go with the next flush
+		if (region.flush.IsValid() && !region.flush.IsReady()) continue;
+		{
+			FScopeLock records_scope(&region.records_lock);
+			if (region.pending_writes.IsEmpty()) continue;
+		}
+
+		region.flush = AsyncPool(*thread_pool, [this, region_coord = pair.Key, &region]()
+			{
+				FlushRegion(region_coord, region);
+			});
+	}
+}
+
+void ChunkRegionCache::EncodePayload(ChunkNoiseField& noise_field, TArray<FSDFOp>& sdf_ops, HermiteData& hermite, ChunkCacheRecord& record)
+{
+	TArray<uint8> raw;
+	FMemoryWriter ar(raw);
+
+	noise_field.Serialize(ar);
+
+	int32 num_ops = sdf_ops.Num();
+	ar << num_ops;
+	for (FSDFOp& op : sdf_ops)
+	{
+		ar << op.position;
+		ar << op.bounds_size;
+		ar << op.mod_type;
+		ar << op.sdf_type;
+	}
+
+	//edges are plain floats and a key, written as they are in memory
+	int32 num_edges = hermite.edges.Num();
+	ar << num_edges;
+	ar.Serialize(hermite.edges.GetData(), num_edges * sizeof(HermiteData::Edge));
+
+	record.header.raw_size = raw.Num();
+
+	int32 compressed_size = FCompression::CompressMemoryBound(NAME_LZ4, raw.Num());
+	record.payload.SetNumUninitialized(compressed_size);
+	if (!FCompression::CompressMemory(NAME_LZ4, record.payload.GetData(), compressed_size, raw.GetData(), raw.Num()) || compressed_size >= raw.Num())
+	{
+		//stored as is, a raw size equal to the compressed one marks it
+		record.payload = MoveTemp(raw);
+		compressed_size = record.payload.Num();
+	}
+	record.payload.SetNum(compressed_size);
+	record.header.compressed_size = compressed_size;
+}
+
+bool ChunkRegionCache::DecodePayload(const ChunkCacheRecord& record, ChunkNoiseField& noise_field, TArray<FSDFOp>& sdf_ops, HermiteData& hermite)
+{
+	const ChunkCacheHeader& header = record.header;
+	if (header.raw_size <= 0 || header.compressed_size != record.payload.Num()) return false;
+
+	TArray<uint8> raw;
+	if (header.raw_size == header.compressed_size)
+	{
+		raw = record.payload;
+	}
+	else
+	{
+		raw.SetNumUninitialized(header.raw_size);
+		if (!FCompression::UncompressMemory(NAME_LZ4, raw.GetData(), header.raw_size, record.payload.GetData(), header.compressed_size)) return false;
+	}
+
+	FMemoryReader ar(raw);
+
+	noise_field.Serialize(ar);
+
+	int32 num_ops = 0;
+	ar << num_ops;
+	if (ar.IsError() || num_ops < 0 || num_ops * static_cast<int64>(sizeof(FSDFOp)) > ar.TotalSize()) return false;
+
+	sdf_ops.SetNum(num_ops);
+	for (FSDFOp& op : sdf_ops)
+	{
+		ar << op.position;
+		ar << op.bounds_size;
+		ar << op.mod_type;
+		ar << op.sdf_type;
+	}
+
+	int32 num_edges = 0;
+	ar << num_edges;
+	if (ar.IsError() || num_edges < 0 || num_edges * static_cast<int64>(sizeof(HermiteData::Edge)) > ar.TotalSize() - ar.Tell()) return false;
+
+	hermite.edges.SetNumUninitialized(num_edges);
+	ar.Serialize(hermite.edges.GetData(), num_edges * sizeof(HermiteData::Edge));
+
+	return !ar.IsError();
+}
+
+ChunkRegionCache::Region& ChunkRegionCache::FindOrAddRegion(const FIntVector3& region_coord)
+{
+	FScopeLock regions_scope(&regions_lock);
+
+	TUniquePtr<Region>& region = regions.FindOrAdd(region_coord);
+	if (!region) region = MakeUnique<Region>();
+	return *region;
+}
+
+void ChunkRegionCache::LoadRegion(const FIntVector3& region_coord, Region& region)
+{
+	if (region.loaded) return;
+	region.loaded = true;
+
+	region.table.SetNumZeroed(records_per_region);
+
+	IFileHandle* file = FPlatformFileManager::Get().GetPlatformFile().OpenRead(*GetRegionPath(region_coord));
+	if (!file) return;
+
+	uint32 file_header[2] = { 0, 0 };
+	const bool valid = file->Size() >= records_offset
+		&& file->Read(reinterpret_cast<uint8*>(file_header), sizeof(file_header))
+		&& file_header[0] == file_magic && file_header[1] == file_version
+		&& file->Read(reinterpret_cast<uint8*>(region.table.GetData()), region.table.Num() * sizeof(TableEntry));
+
+	//files of another version are started over by the next write
+	if (valid)
+	{
+		region.file_size = file->Size();
+		for (TableEntry& entry : region.table)
+		{
+			if (entry.size && entry.offset + entry.size > region.file_size) entry = TableEntry{};
+			region.live_bytes += entry.size;
+		}
+	}
+	else
+	{
+		FMemory::Memzero(region.table.GetData(), region.table.Num() * sizeof(TableEntry));
+	}
+
+	delete file;
+}
+
+bool ChunkRegionCache::MapRegion(const FIntVector3& region_coord, Region& region)
+{
+	UnmapRegion(region);
+	if (region.file_size == 0) return false;
+
+	if (num_mapped >= max_mapped_regions) UnmapLeastRecentlyUsed(region);
+
+	region.mapped_file = FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*GetRegionPath(region_coord));
+	if (!region.mapped_file) return false;
+
+	region.mapped_region = region.mapped_file->MapRegion(0, region.mapped_file->GetFileSize());
+	if (!region.mapped_region)
+	{
+		delete region.mapped_file;
+		region.mapped_file = nullptr;
+		return false;
+	}
+
+	num_mapped++;
+	return true;
+}
+
+void ChunkRegionCache::UnmapRegion(Region& region)
+{
+	if (!region.mapped_file) return;
+
+	delete region.mapped_region;
+	delete region.mapped_file;
+	region.mapped_region = nullptr;
+	region.mapped_file = nullptr;
+	num_mapped--;
+}
+
+void ChunkRegionCache::UnmapLeastRecentlyUsed(const Region& caller)
+{
+	FScopeLock regions_scope(&regions_lock);
+
+	//regions busy on another thread are in use anyway, try locking never waits on them
+	Region* oldest = nullptr;
+	for (TPair<FIntVector3, TUniquePtr<Region>>& pair : regions)
+	{
+		Region& region = *pair.Value;
+		if (&region == &caller || !region.file_lock.TryLock()) continue;
+
+		if (region.mapped_file && (!oldest || region.last_used < oldest->last_used))
+		{
+			if (oldest) oldest->file_lock.Unlock();
+			oldest = &region;
+		}
+		else
+		{
+			region.file_lock.Unlock();
+		}
+	}
+
+	if (!oldest) return;
+	UnmapRegion(*oldest);
+	oldest->file_lock.Unlock();
+}
+
+void ChunkRegionCache::FlushRegion(const FIntVector3& region_coord, Region& region)
+{
+	{
+		FScopeLock records_scope(&region.records_lock);
+		if (region.pending_writes.IsEmpty()) return;
+		region.flushing_writes = MoveTemp(region.pending_writes);
+		region.pending_writes.Reset();
+	}
+
+	{
+		FScopeLock file_scope(&region.file_lock);
+		LoadRegion(region_coord, region);
+
+		//mapped files can't be written to on every platform, the next read past the old mapping maps it again
+		UnmapRegion(region);
+
+		const FString path = GetRegionPath(region_coord);
+		const bool new_file = region.file_size == 0;
+
+		IFileHandle* file = FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*path, !new_file, true);
+		if (file)
+		{
+			if (new_file)
+			{
+				uint32 file_header[2] = { file_magic, file_version };
+				FMemory::Memzero(region.table.GetData(), region.table.Num() * sizeof(TableEntry));
+				file->Write(reinterpret_cast<const uint8*>(file_header), sizeof(file_header));
+				file->Write(reinterpret_cast<const uint8*>(region.table.GetData()), region.table.Num() * sizeof(TableEntry));
+				region.file_size = records_offset;
+				region.live_bytes = 0;
+			}
+
+			file->Seek(static_cast<int64>(region.file_size));
+
+			//flushing_writes is only touched by this flush until it is emptied below
+			TArray<uint8> bytes;
+			for (TPair<int32, ChunkCacheRecord>& pair : region.flushing_writes)
+			{
+				bytes.Reset();
+				FMemoryWriter writer(bytes);
+				ChunkCacheHeader header = pair.Value.header;
+				SerializeHeader(writer, header);
+				bytes.Append(pair.Value.payload);
+
+				//the old record stays behind as dead bytes until the file is compacted
+				TableEntry& entry = region.table[pair.Key];
+				region.live_bytes -= entry.size;
+
+				entry.offset = region.file_size;
+				entry.size = bytes.Num();
+				entry.reserved = 0;
+
+				file->Write(bytes.GetData(), bytes.Num());
+
+				region.file_size += bytes.Num();
+				region.live_bytes += bytes.Num();
+			}
+
+			file->Seek(table_offset);
+			file->Write(reinterpret_cast<const uint8*>(region.table.GetData()), region.table.Num() * sizeof(TableEntry));
+			delete file;
+
+			const uint64 dead_bytes = region.file_size - records_offset - region.live_bytes;
+			if (dead_bytes > region.live_bytes && dead_bytes > 1024 * 1024) CompactRegion(region_coord, region);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Warning, TEXT("DC region cache: can't open %s for writing"), *path);
+		}
+	}
+
+	FScopeLock records_scope(&region.records_lock);
+	region.flushing_writes.Empty();
+}
+
+void ChunkRegionCache::CompactRegion(const FIntVector3& region_coord, Region& region)
+{
+	const FString path = GetRegionPath(region_coord);
+
+	TArray<uint8> old_file;
+	if (!FFileHelper::LoadFileToArray(old_file, *path)) return;
+
+	TArray<uint8> new_file;
+	new_file.Reserve(records_offset + region.live_bytes);
+	new_file.SetNumZeroed(records_offset);
+
+	uint32 file_header[2] = { file_magic, file_version };
+	FMemory::Memcpy(new_file.GetData(), file_header, sizeof(file_header));
+
+	TArray<TableEntry> table = region.table;
+	for (TableEntry& entry : table)
+	{
+		if (entry.size == 0) continue;
+
+		const uint64 offset = new_file.Num();
+		new_file.Append(old_file.GetData() + entry.offset, entry.size);
+		entry.offset = offset;
+	}
+	FMemory::Memcpy(new_file.GetData() + table_offset, table.GetData(), table.Num() * sizeof(TableEntry));
+
+	if (FFileHelper::SaveArrayToFile(new_file, *path))
+	{
+		region.table = MoveTemp(table);
+		region.file_size = new_file.Num();
+		return;
+	}
+
+	//a half written file can't be trusted, the region starts over
+	UE_LOG(LogTemp, Warning, TEXT("DC region cache: can't compact %s, dropping it"), *path);
+	FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*path);
+	FMemory::Memzero(region.table.GetData(), region.table.Num() * sizeof(TableEntry));
+	region.file_size = 0;
+	region.live_bytes = 0;
+}
+
+FString ChunkRegionCache::GetRegionPath(const FIntVector3& region_coord) const
+{
+	return FPaths::Combine(directory, FString::Printf(TEXT("r.%d.%d.%d.dcr"), region_coord.X, region_coord.Y, region_coord.Z));
+}
+
+FIntVector3 ChunkRegionCache::GetRegionCoord(const FIntVector3& coord)
+{
+	return FIntVector3(FMath::FloorToInt(static_cast<float>(coord.X) / region_dim), FMath::FloorToInt(static_cast<float>(coord.Y) / region_dim), FMath::FloorToInt(static_cast<float>(coord.Z) / region_dim));
+}
+
+int32 ChunkRegionCache::GetRecordIndex(const FIntVector3& coord)
+{
+	const FIntVector3 local = coord - GetRegionCoord(coord) * region_dim;
+	return local.Z + (local.Y * region_dim) + (local.X * region_dim * region_dim);
+}
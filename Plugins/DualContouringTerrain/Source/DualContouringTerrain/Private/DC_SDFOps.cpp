@@ -14,3 +14,71 @@ float SDF::Sphere(const FVector3f& p, float radius)
 {
 	return p.Length() - radius;
 }
+
+VectorRegister4Float SDF::Box(const VectorRegister4Float& px, const VectorRegister4Float& py, const VectorRegister4Float& pz, const FVector3f& extent)
+{
+	const VectorRegister4Float zero = VectorZeroFloat();
+
+	const VectorRegister4Float qx = VectorSubtract(VectorAbs(px), VectorSetFloat1(extent.X));
+	const VectorRegister4Float qy = VectorSubtract(VectorAbs(py), VectorSetFloat1(extent.Y));
+	const VectorRegister4Float qz = VectorSubtract(VectorAbs(pz), VectorSetFloat1(extent.Z));
+
+	const VectorRegister4Float ox = VectorMax(qx, zero);
+	const VectorRegister4Float oy = VectorMax(qy, zero);
+	const VectorRegister4Float oz = VectorMax(qz, zero);
+
+	const VectorRegister4Float outside = VectorSqrt(VectorMultiplyAdd(ox, ox, VectorMultiplyAdd(oy, oy, VectorMultiply(oz, oz))));
+	const VectorRegister4Float inside = VectorMin(VectorMax(qx, VectorMax(qy, qz)), zero);
+
+	return VectorAdd(outside, inside);
+}
+
+VectorRegister4Float SDF::Sphere(const VectorRegister4Float& px, const VectorRegister4Float& py, const VectorRegister4Float& pz, float radius)
+{
+	const VectorRegister4Float length = VectorSqrt(VectorMultiplyAdd(px, px, VectorMultiplyAdd(py, py, VectorMultiply(pz, pz))));
+
+	return VectorSubtract(length, VectorSetFloat1(radius));
+}
+
+FBox3f FSDFOp::GetInfluenceBounds() const
+{
+	const float inflate_factor = 2.f;
+	//min / max against the noise reach as far as densities do, noise stays within about one density unit (100 world units)
+	const float density_reach = 100.f;
+
+	const FVector3f extent = bounds_size * 0.5f * inflate_factor + FVector3f(density_reach);
+
+	return FBox3f(position - extent, position + extent);
+}
+
+FVector3f SDF::BoxGradient(const FVector3f& p, const FVector3f& extent)
+{
+	FVector3f q = p.GetAbs() - extent;
+	FVector3f sign = FVector3f(FMath::Sign(p.X), FMath::Sign(p.Y), FMath::Sign(p.Z));
+
+	//outside: direction from the closest point on the box
+	if (q.GetMax() > 0.f)
+	{
+		return (q.ComponentMax(FVector3f(0.f)) * sign).GetSafeNormal();
+	}
+
+	//inside: normal of the closest face
+	const int32 axis = (q.X >= q.Y && q.X >= q.Z) ? 0 : (q.Y >= q.Z ? 1 : 2);
+
+	//on a diagonal of the box (two faces equally close) or its center plane the face is ambiguous, zero lets callers fall back
+	const float tie_tolerance = 1e-4f;
+	for (int32 i = 0; i < 3; i++)
+	{
+		if (i != axis && q[i] >= q[axis] - tie_tolerance) return FVector3f(0.f);
+	}
+	if (sign[axis] == 0.f) return FVector3f(0.f);
+
+	FVector3f gradient = FVector3f(0.f);
+	gradient[axis] = sign[axis];
+	return gradient;
+}
+
+FVector3f SDF::SphereGradient(const FVector3f& p, float radius)
+{
+	return p.GetSafeNormal();
+}
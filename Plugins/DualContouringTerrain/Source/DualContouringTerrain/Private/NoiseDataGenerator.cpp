@@ -6,6 +6,10 @@
 FastNoise::SmartNode<FastNoise::Generator> UNoiseDataGenerator::generator = FastNoise::New<FastNoise::Checkerboard>();
 FastNoise::SmartNode<FastNoise::DomainOffset> UNoiseDataGenerator::finalizer_offset = FastNoise::New<FastNoise::DomainOffset>();
 FastNoise::SmartNode<FastNoise::DomainScale> UNoiseDataGenerator::finalizer_scale = FastNoise::New<FastNoise::DomainScale>();
+FastNoise::SmartNode<FastNoise::DomainScale> UNoiseDataGenerator::grid_scales[UNoiseDataGenerator::max_grid_depth + 1];
+FString UNoiseDataGenerator::encoded_node_tree;
+float UNoiseDataGenerator::finalizer_scaling = 1.f;
+FVector UNoiseDataGenerator::sample_offset = FVector::ZeroVector;
 
 FString UNoiseDataGenerator::GetCPUSIMDFeatureSet()
 {
@@ -17,6 +21,7 @@ void UNoiseDataGenerator::SetSampleOffset(FVector offset)
     finalizer_offset->SetOffset<FastNoise::Dim::X>(offset.X);
     finalizer_offset->SetOffset<FastNoise::Dim::Y>(offset.Y);
     finalizer_offset->SetOffset<FastNoise::Dim::Z>(offset.Z);
+    sample_offset = offset;
 }
 
 void UNoiseDataGenerator::Initialize(FSubsystemCollectionBase& Collection)
@@ -27,13 +32,20 @@ void UNoiseDataGenerator::Initialize(FSubsystemCollectionBase& Collection)
    /* generator = FastNoise::New<FastNoise::Checkerboard>();
     finalizer_offset = FastNoise::New<FastNoise::DomainOffset>();
     finalizer_scale = FastNoise::New<FastNoise::DomainScale>();*/
-    finalizer_scale->SetScaling(6.f);
+    finalizer_scaling = 6.f;
+    finalizer_scale->SetScaling(finalizer_scaling);
 
     //checkerboard test: Av8=
     GeneratorFromNoiseToolString(FString("BgQ="));
 
     finalizer_scale->SetSource(generator);
     finalizer_offset->SetSource(finalizer_scale);
+
+    for (int32 depth = 0; depth <= max_grid_depth; depth++)
+    {
+        grid_scales[depth] = FastNoise::New<FastNoise::DomainScale>();
+        grid_scales[depth]->SetSource(finalizer_offset);
+    }
 }
 
 void UNoiseDataGenerator::Deinitialize()
@@ -44,6 +56,16 @@ void UNoiseDataGenerator::Deinitialize()
 void UNoiseDataGenerator::GeneratorFromNoiseToolString(FString string)
 {
     generator = FastNoise::NewFromEncodedNodeTree(TCHAR_TO_ANSI(string.GetCharArray().GetData()));
+    encoded_node_tree = string;
+}
+
+uint32 UNoiseDataGenerator::GetGeneratorHash()
+{
+    //encoded trees are case sensitive, GetTypeHash of a string isn't
+    uint32 hash = FCrc::StrCrc32(*encoded_node_tree);
+    hash = HashCombine(hash, GetTypeHash(finalizer_scaling));
+    hash = HashCombine(hash, GetTypeHash(sample_offset));
+    return hash;
 }
 
 //UE::Tasks::TTask<TArray<float>> UNoiseDataGenerator::GetNoiseFromPositions3D(const float* x_pos, const float* y_pos, const float* z_pos, int count) const
@@ -81,6 +103,37 @@ TArray<float> UNoiseDataGenerator::GetNoiseFromPositions3D_NonThreaded(const flo
 //    }, LowLevelTasks::ETaskPriority::BackgroundHigh);
 //}
 
+void UNoiseDataGenerator::SetGridChunkSize(float chunk_size)
+{
+    for (int32 depth = 0; depth <= max_grid_depth; depth++)
+    {
+        //same 0.01 scaling as the position array samples
+        grid_scales[depth]->SetScaling(chunk_size / static_cast<float>(1 << depth) * 0.01f);
+    }
+}
+
+void UNoiseDataGenerator::GetNoiseUniformGrid3D(float* out, int32 out_dim, const FIntVector3& out_offset, const FIntVector3& start, const FIntVector3& size, int32 depth, int32 seed)
+{
+    checkSlow(depth <= max_grid_depth);
+
+    //fastnoise writes x fastest, transposed into the z fastest field below
+    TArray<float> scratch;
+    scratch.SetNumUninitialized(size.X * size.Y * size.Z);
+    grid_scales[depth]->GenUniformGrid3D(scratch.GetData(), start.X, start.Y, start.Z, size.X, size.Y, size.Z, seed);
+
+    int32 i = 0;
+    for (int32 z = 0; z < size.Z; z++)
+    {
+        for (int32 y = 0; y < size.Y; y++)
+        {
+            for (int32 x = 0; x < size.X; x++, i++)
+            {
+                out[(z + out_offset.Z) + (y + out_offset.Y) * out_dim + (x + out_offset.X) * out_dim * out_dim] = scratch[i];
+            }
+        }
+    }
+}
+
 float UNoiseDataGenerator::GetNoiseSingle3D(float x, float y, float z, int32 seed)
 {
     return finalizer_offset->GenSingle3D(x, y, z, seed);
@@ -6,10 +6,12 @@
 
 #include "DC_NoiseDataGenerator.h"
 #include "DC_OctreeNode.h"
+#include "DC_QuadricBatch.h"
 #include <cmath>
 #include "probabilistic-quadrics.hh"
 #include "DC_Mat3x3.h"
 #include "Interface/Core/RealtimeMeshBuilder.h"
+#include "Async/ParallelFor.h"
 //#include "RealtimeMeshComponent.h"
 //#include "RealtimeMeshSimple.h"
 #include "DC_OctreeRenderActor.h"
@@ -65,15 +67,82 @@ constexpr unsigned char edges_corner_map[12][2] =
 	{0,1},{2,3},{4,5},{6,7}		// z-axis
 };
 
-void UOctreeCode::ConstructLeafNode(OctreeNode* node, const FVector3f& node_p, const float* corner_densities, uint8 corners, const OctreeSettingsMultithreadContext& settings_context)
+//edge mask (bit i set if edge i of edges_corner_map has a sign change) of every corner mask
+struct EdgeMaskTable
+{
+	uint16 masks[256];
+
+	constexpr EdgeMaskTable() : masks()
+	{
+		for (int32 corners = 0; corners < 256; corners++)
+		{
+			uint16 mask = 0;
+			for (int32 i = 0; i < 12; i++)
+			{
+				mask |= static_cast<uint16>((((corners >> edges_corner_map[i][0]) ^ (corners >> edges_corner_map[i][1])) & 1) << i);
+			}
+			masks[corners] = mask;
+		}
+	}
+};
+
+static constexpr EdgeMaskTable edge_mask_table;
+
+static FORCEINLINE void GatherCornerDensities(const TArray<float>& noise, const FIntVector3& lc, int32 dim, float* corner_densities)
+{
+	corner_densities[0] = noise[UOctreeCode::Get1DIndexFrom3D(lc.X, lc.Y, lc.Z, dim)];
+	corner_densities[1] = noise[UOctreeCode::Get1DIndexFrom3D(lc.X + 1, lc.Y, lc.Z, dim)];
+	corner_densities[2] = noise[UOctreeCode::Get1DIndexFrom3D(lc.X, lc.Y, lc.Z + 1, dim)];
+	corner_densities[3] = noise[UOctreeCode::Get1DIndexFrom3D(lc.X + 1, lc.Y, lc.Z + 1, dim)];
+	corner_densities[4] = noise[UOctreeCode::Get1DIndexFrom3D(lc.X, lc.Y + 1, lc.Z, dim)];
+	corner_densities[5] = noise[UOctreeCode::Get1DIndexFrom3D(lc.X + 1, lc.Y + 1, lc.Z, dim)];
+	corner_densities[6] = noise[UOctreeCode::Get1DIndexFrom3D(lc.X, lc.Y + 1, lc.Z + 1, dim)];
+	corner_densities[7] = noise[UOctreeCode::Get1DIndexFrom3D(lc.X + 1, lc.Y + 1, lc.Z + 1, dim)];
+}
+
+// HermiteData key of edge edge_idx of the voxel at lc, dim samples per axis
+static FORCEINLINE uint32 GetHermiteEdgeKey(const FIntVector3& lc, int32 edge_idx, int32 dim)
+{
+	//the first corner of every edges_corner_map pair is the lower sample, the corners differ in the bit of the edge's axis
+	const uint8 c = edges_corner_map[edge_idx][0];
+	const uint8 axis_bit = edges_corner_map[edge_idx][0] ^ edges_corner_map[edge_idx][1];
+	const uint32 axis = axis_bit == 1 ? 0 : (axis_bit == 4 ? 1 : 2);
+
+	return static_cast<uint32>(UOctreeCode::Get1DIndexFrom3D(lc.X + (c & 1), lc.Y + ((c >> 2) & 1), lc.Z + ((c >> 1) & 1), dim)) * 3 + axis;
+}
+
+// appends the intersections and normals of batch to hermite, unsorted
+static void AppendHermiteEdges(const LeafIntersectionBatch& batch, const TArray<FVector3f>& normals, HermiteData& hermite)
+{
+	hermite.edges.Reserve(hermite.edges.Num() + batch.edges.Num());
+
+	for (int32 i = 0; i < batch.edges.Num(); i++)
+	{
+		hermite.edges.Add(HermiteData::Edge{ batch.edges[i], batch.intersections[i], normals[i] });
+	}
+}
+
+// runs func(octant, octant_arena) for the 8 root octants on separate workers. nodes allocated below an octant
+// come from its own arena, all of them end up in arena afterwards
+template<typename FuncType>
+static void ForEachOctantParallel(OctreeNodeArena& arena, FuncType&& func)
+{
+	OctreeNodeArena octant_arenas[8];
+
+	ParallelFor(8, [&](int32 i)
+		{
+			func(i, octant_arenas[i]);
+		});
+
+	for (OctreeNodeArena& octant_arena : octant_arenas)
+	{
+		arena.Append(MoveTemp(octant_arena));
+	}
+}
+
+void UOctreeCode::ConstructLeafNode(OctreeNode* node, const FVector3f& node_p, const FIntVector3& cell, const float* corner_densities, uint8 corners, const OctreeSettingsMultithreadContext& settings_context, OctreeNodeArena& arena, LeafIntersectionBatch& batch)
 {
-	//const unsigned int MAX_ZERO_CROSSINGS = 6;
 	const int8 max_depth = settings_context.max_depth;
-	const float iso_surface = settings_context.iso_surface;
-	const float stddev_pos = settings_context.stddev_pos;
-	const float stddev_normal = settings_context.stddev_normal;
-	const float fdm_normal_offset = settings_context.normal_fdm_offset;
-	const int32 seed = settings_context.seed;
 
 	while(node->depth != max_depth)
 	{
@@ -81,41 +150,23 @@ void UOctreeCode::ConstructLeafNode(OctreeNode* node, const FVector3f& node_p, c
 
 		if (!node->children[this_idx])
 		{
-			node->children[this_idx] = MakeUniqueForOverwrite<OctreeNode>();
-			//OctreeNode* new_node = new OctreeNode();
+			node->children[this_idx] = arena.Allocate();
 			node->children[this_idx]->depth = node->depth + 1;
 			node->children[this_idx]->center = node->center + child_offsets[this_idx] * node->size * 0.25f;
 			node->children[this_idx]->size = node->size * 0.5f;
 
 		}
 
-		node = node->children[this_idx].Get();
-	}
-
-	uint16 edge_mask = 0;
-	for (uint8 i = 0; i < 12; i++)
-	{
-		auto c1 = edges_corner_map[i][0];
-		auto c2 = edges_corner_map[i][1];
-
-		edge_mask |= (((corners >> c1) ^ (corners >> c2)) & 1) << i;
+		node = node->children[this_idx];
 	}
 
-	//node is a leaf
-	node->type = NODE_LEAF;
-	node->corners = corners;
-
-	//FVector3f mass_point{};
-	uint8 edge_count = 0;
-
-	//UE_ASSUME(edge_count != 0);
-	FVector3f& vert_normal = node->leaf_data.normal;
-	vert_normal = FVector3f(0.f);
-
-	quadric3& vox_pq = node->leaf_data.qef;
+	EmitLeafNode(node, cell, corner_densities, corners, settings_context, batch);
+}
 
-	const FVector3f node_center = node->center;
-	const float node_size = node->size;
+// scaled edge intersections of the voxel at center (lattice cell lc, dim samples per axis) with the given corner signs and their edge keys, in edges_corner_map order
+static void AppendEdgeIntersections(const FVector3f& center, float size, const FIntVector3& lc, int32 dim, const float* corner_densities, uint8 corners, float iso_surface, LeafIntersectionBatch& batch)
+{
+	uint16 edge_mask = edge_mask_table.masks[corners];
 
 	while(edge_mask /*&& edge_count < MAX_ZERO_CROSSINGS*/)
 	{
@@ -124,14 +175,9 @@ void UOctreeCode::ConstructLeafNode(OctreeNode* node, const FVector3f& node_p, c
 		//unset last 1 bit trick
 		edge_mask &= (edge_mask - 1);
 
-		/*unsigned char s1 = (corners >> edges_corner_map[i][0]) & 1;
-		unsigned char s2 = (corners >> edges_corner_map[i][1]) & 1;
-
-		if (s1 == s2) continue;*/
-
 		//detected sign change on current edge
-		FVector3f corner_1 = (child_offsets[edges_corner_map[idx][0]] * node_size * 0.5f) + node_center;
-		FVector3f corner_2 = (child_offsets[edges_corner_map[idx][1]] * node_size * 0.5f) + node_center;
+		FVector3f corner_1 = (child_offsets[edges_corner_map[idx][0]] * size * 0.5f) + center;
+		FVector3f corner_2 = (child_offsets[edges_corner_map[idx][1]] * size * 0.5f) + center;
 
 		float d1 = corner_densities[edges_corner_map[idx][0]] - iso_surface;
 		float d2 = corner_densities[edges_corner_map[idx][1]] - iso_surface;
@@ -142,195 +188,291 @@ void UOctreeCode::ConstructLeafNode(OctreeNode* node, const FVector3f& node_p, c
 		// alpha = d1 / (d1-d2)
 		float alpha = d1 / (d1 - d2 + FLT_EPSILON);
 
-		FVector3f intersection = FMath::Lerp(corner_1, corner_2, alpha);
-		//mass_point += intersection;
-
 		//at 32 vox size, i dont think it's worth doing better zero crossing. below usually gives values in order of 0.001 > x > -0.001
 		//float alpha_density = noise_gen->GetNoiseSingle3D(intersection.X * scale_factor, intersection.Y * scale_factor, intersection.Z * scale_factor) - octree_settings->iso_surface;
 
-		FVector3f normal = FDMGetNormal(intersection * scale_factor, fdm_normal_offset, seed);
-		vert_normal += normal;
-
-		vox_pq += quadric3::probabilistic_plane_quadric(intersection * scale_factor, normal, stddev_pos, stddev_normal);
-		edge_count++;
+		batch.intersections.Add(FMath::Lerp(corner_1, corner_2, alpha) * scale_factor);
+		batch.edges.Add(GetHermiteEdgeKey(lc, idx, dim));
 	}
+}
+
+void UOctreeCode::EmitLeafNode(OctreeNode* node, const FIntVector3& cell, const float* corner_densities, uint8 corners, const OctreeSettingsMultithreadContext& settings_context, LeafIntersectionBatch& batch)
+{
+	//const unsigned int MAX_ZERO_CROSSINGS = 6;
+
+	//node is a leaf
+	node->type = NODE_LEAF;
+	node->corners = corners;
 
-	vert_normal /= edge_count;
+	batch.leaves.Add(node);
+	batch.intersection_counts.Add(static_cast<uint8>(FMath::CountBits(edge_mask_table.masks[corners])));
 
-	node->leaf_data.minimizer = vox_pq.minimizer();
+	AppendEdgeIntersections(node->center, node->size, cell, GetDim(settings_context.max_depth) + 1, corner_densities, corners, settings_context.iso_surface, batch);
+}
 
-#if CLAMP_MINIMIZERS
+void UOctreeCode::SampleIntersectionNormals(LeafIntersectionBatch& batch, float leaf_size, const OctreeSettingsMultithreadContext& settings_context, const TArray<FSDFOp>* sdf_ops, const HermiteData* known_hermite, TArray<FVector3f>& normals)
+{
+	const float h = settings_context.normal_fdm_offset;
 
-	float half_size = node->size * 0.5f * scale_factor;
-	FVector3f scaled_center = node->center * scale_factor;
+	const int32 intersection_count = batch.intersections.Num();
+	const bool has_sdf_ops = sdf_ops && !sdf_ops->IsEmpty();
+	const bool analytic_gradients = settings_context.analytic_gradients && has_sdf_ops;
 
-	if (node->leaf_data->minimizer.X > scaled_center.X + half_size)
-	{
-		node->leaf_data->minimizer.X = scaled_center.X + half_size;
-	}
-	if (node->leaf_data->minimizer.Y > scaled_center.Y + half_size)
+	normals.SetNumUninitialized(intersection_count);
+
+	//intersections whose normal is not known yet
+	TArray<int32> unknown_intersections;
+	unknown_intersections.Reserve(intersection_count);
+
+	if (known_hermite && !known_hermite->IsEmpty())
 	{
-		node->leaf_data->minimizer.Y = scaled_center.Y + half_size;
+		for (int32 i = 0; i < intersection_count; i++)
+		{
+			const HermiteData::Edge* edge = known_hermite->Find(batch.edges[i]);
+			if (!edge)
+			{
+				unknown_intersections.Add(i);
+				continue;
+			}
+
+			batch.intersections[i] = edge->position;
+			normals[i] = edge->normal;
+		}
 	}
-	if (node->leaf_data->minimizer.Z > scaled_center.Z + half_size)
+	else
 	{
-		node->leaf_data->minimizer.Z = scaled_center.Z + half_size;
+		for (int32 i = 0; i < intersection_count; i++)
+		{
+			unknown_intersections.Add(i);
+		}
 	}
 
+	//intersections whose normal still has to come from fdm samples of the noise
+	TArray<int32> fdm_intersections;
+	fdm_intersections.Reserve(unknown_intersections.Num());
 
-	if (node->leaf_data->minimizer.X < scaled_center.X - half_size)
+	if (analytic_gradients)
 	{
-		node->leaf_data->minimizer.X = scaled_center.X - half_size;
+		//the interpolated intersection is only accurate to within the voxel
+		const float eps = leaf_size * 0.5f * scale_factor;
+
+		//the chain starts from the noise, one sample per intersection decides which term wins
+		const int32 unknown_count = unknown_intersections.Num();
+		TArray<float> x_points, y_points, z_points;
+		x_points.SetNumUninitialized(unknown_count);
+		y_points.SetNumUninitialized(unknown_count);
+		z_points.SetNumUninitialized(unknown_count);
+
+		for (int32 i = 0; i < unknown_count; i++)
+		{
+			const FVector3f& p = batch.intersections[unknown_intersections[i]];
+			x_points[i] = p.X;
+			y_points[i] = p.Y;
+			z_points[i] = p.Z;
+		}
+
+		TArray<float> point_noise;
+		if (unknown_count > 0)
+		{
+			point_noise = UNoiseDataGenerator::GetNoiseFromPositions3D_NonThreaded(x_points.GetData(), y_points.GetData(), z_points.GetData(), unknown_count, settings_context.seed);
+		}
+
+		for (int32 i = 0; i < unknown_count; i++)
+		{
+			const int32 intersection_idx = unknown_intersections[i];
+			if (!GetSDFOpsGradient(batch.intersections[intersection_idx], point_noise[i], settings_context.iso_surface, eps, *sdf_ops, normals[intersection_idx]))
+			{
+				fdm_intersections.Add(intersection_idx);
+			}
+		}
 	}
-	if (node->leaf_data->minimizer.Y < scaled_center.Y - half_size)
+	else
 	{
-		node->leaf_data->minimizer.Y = scaled_center.Y - half_size;
+		fdm_intersections = MoveTemp(unknown_intersections);
 	}
-	if (node->leaf_data->minimizer.Z < scaled_center.Z - half_size)
+
+	const int32 fdm_count = fdm_intersections.Num();
+	const int32 sample_count = fdm_count * 6;
+
+	//6 fdm samples per intersection in x, y, z axii order, all evaluated in a single noise dispatch
+	TArray<float> x_positions, y_positions, z_positions;
+	x_positions.SetNumUninitialized(sample_count);
+	y_positions.SetNumUninitialized(sample_count);
+	z_positions.SetNumUninitialized(sample_count);
+
+	for (int32 i = 0; i < fdm_count; i++)
 	{
-		node->leaf_data->minimizer.Z = scaled_center.Z - half_size;
+		const FVector3f& p = batch.intersections[fdm_intersections[i]];
+		float* x = x_positions.GetData() + i * 6;
+		float* y = y_positions.GetData() + i * 6;
+		float* z = z_positions.GetData() + i * 6;
+
+		x[0] = p.X + h; x[1] = p.X - h; x[2] = p.X;     x[3] = p.X;     x[4] = p.X;     x[5] = p.X;
+		y[0] = p.Y;     y[1] = p.Y;     y[2] = p.Y + h; y[3] = p.Y - h; y[4] = p.Y;     y[5] = p.Y;
+		z[0] = p.Z;     z[1] = p.Z;     z[2] = p.Z;     z[3] = p.Z;     z[4] = p.Z + h; z[5] = p.Z - h;
 	}
-#endif
 
-#if UE_BUILD_DEBUG
-	if (isnan(node->leaf_data->minimizer.X) || isnan(node->leaf_data->minimizer.Y) || isnan(node->leaf_data->minimizer.Z))
+	if (sample_count > 0)
 	{
-		check(false);
-	}
+		TArray<float> noise;
+		{
+#if USE_NAMED_STATS
+			QUICK_SCOPE_CYCLE_COUNTER(Stat_FinalizeLeafNodes_NormalSampling)
 #endif
+			noise = UNoiseDataGenerator::GetNoiseFromPositions3D_NonThreaded(x_positions.GetData(), y_positions.GetData(), z_positions.GetData(), sample_count, settings_context.seed);
+		}
+
+		//with analytic gradients the sdf terms are already resolved, what is left lies on the plain noise surface
+		if (has_sdf_ops && !analytic_gradients)
+		{
+			ApplySDFOps(noise.GetData(), x_positions.GetData(), y_positions.GetData(), z_positions.GetData(), sample_count, *sdf_ops);
+		}
+
+		const float inv_2h = 1.f / (2.f * h);
+
+		for (int32 i = 0; i < fdm_count; i++)
+		{
+			const float* n = noise.GetData() + i * 6;
+
+			FVector3f normal = FVector3f(n[0] - n[1], n[2] - n[3], n[4] - n[5]) * inv_2h;
+			normals[fdm_intersections[i]] = normal.GetUnsafeNormal();
+		}
+	}
 }
 
-void UOctreeCode::ConstructLeafNode_Edit(OctreeNode* node, const FVector3f& node_p, const float* corner_densities, uint8 corners, const OctreeSettingsMultithreadContext& settings_context, const TArray<FSDFOp>& sdf_ops)
+void UOctreeCode::SolveLeafQEFs(const LeafIntersectionBatch& batch, const TArray<FVector3f>& normals, const OctreeSettingsMultithreadContext& settings_context, TArray<FVector3f>& minimizers, TArray<quadric3>* qefs)
 {
-	//const unsigned int MAX_ZERO_CROSSINGS = 6;
-	const int8 max_depth = settings_context.max_depth;
-	const float iso_surface = settings_context.iso_surface;
 	const float stddev_pos = settings_context.stddev_pos;
 	const float stddev_normal = settings_context.stddev_normal;
-	const float fdm_normal_offset = settings_context.normal_fdm_offset;
-	const int32 seed = settings_context.seed;
+	const int32 leaf_count = batch.intersection_counts.Num();
+
+	minimizers.SetNumUninitialized(leaf_count);
+	if (qefs) qefs->SetNumUninitialized(leaf_count);
 
-	while (node->depth != max_depth)
+	//soa qefs, 4 leaves per simd lane group. the per leaf quadric3 path below is the scalar reference
+	if (settings_context.batched_qef)
 	{
-		uint8 this_idx = GetChildNodeFromPosition(node_p, node->center);
+#if USE_NAMED_STATS
+		QUICK_SCOPE_CYCLE_COUNTER(Stat_FinalizeLeafNodes_BatchedQEF)
+#endif
 
-		if (!node->children[this_idx])
+		TArray<int32> plane_offsets;
+		plane_offsets.SetNumUninitialized(leaf_count);
+
+		int32 offset = 0;
+		for (int32 leaf_idx = 0; leaf_idx < leaf_count; leaf_idx++)
 		{
-			node->children[this_idx] = MakeUniqueForOverwrite<OctreeNode>();
-			//OctreeNode* new_node = new OctreeNode();
-			node->children[this_idx]->depth = node->depth + 1;
-			node->children[this_idx]->center = node->center + child_offsets[this_idx] * node->size * 0.25f;
-			node->children[this_idx]->size = node->size * 0.5f;
+			plane_offsets[leaf_idx] = offset;
+			offset += batch.intersection_counts[leaf_idx];
 		}
 
-		node = node->children[this_idx].Get();
-	}
-
-	uint16 edge_mask = 0;
-	for (uint8 i = 0; i < 12; i++)
-	{
-		auto c1 = edges_corner_map[i][0];
-		auto c2 = edges_corner_map[i][1];
-
-		edge_mask |= (((corners >> c1) ^ (corners >> c2)) & 1) << i;
-	}
-
-	//node is a leaf
-	node->type = NODE_LEAF;
-	node->corners = corners;
+		QuadricBatch batched_qefs;
+		batched_qefs.Init(leaf_count);
+		batched_qefs.AccumulatePlaneQuadrics(plane_offsets.GetData(), batch.intersection_counts.GetData(), batch.intersections.GetData(), normals.GetData(), stddev_pos, stddev_normal);
+		batched_qefs.Solve(minimizers.GetData(), nullptr);
 
-	//FVector3f mass_point{};
-	uint8 edge_count = 0;
+		if (!qefs) return;
 
-	//UE_ASSUME(edge_count != 0);
-	FVector3f& vert_normal = node->leaf_data.normal;
-	vert_normal = FVector3f(0.f);
-	quadric3& vox_pq = node->leaf_data.qef;
+		for (int32 leaf_idx = 0; leaf_idx < leaf_count; leaf_idx++)
+		{
+			(*qefs)[leaf_idx] = batched_qefs.Get(leaf_idx);
+		}
 
-	const FVector3f node_center = node->center;
-	const float node_size = node->size;
+		return;
+	}
 
-	while (edge_mask /*&& edge_count < MAX_ZERO_CROSSINGS*/)
+	int32 intersection_idx = 0;
+	for (int32 leaf_idx = 0; leaf_idx < leaf_count; leaf_idx++)
 	{
-		int32 idx = FMath::CountTrailingZeros(static_cast<uint32>(edge_mask));
+		quadric3 vox_pq;
 
-		//unset last 1 bit trick
-		edge_mask &= (edge_mask - 1);
+		for (uint8 e = 0; e < batch.intersection_counts[leaf_idx]; e++, intersection_idx++)
+		{
+			vox_pq += quadric3::probabilistic_plane_quadric(batch.intersections[intersection_idx], normals[intersection_idx], stddev_pos, stddev_normal);
+		}
 
-		/*unsigned char s1 = (corners >> edges_corner_map[i][0]) & 1;
-		unsigned char s2 = (corners >> edges_corner_map[i][1]) & 1;
+		minimizers[leaf_idx] = vox_pq.minimizer();
+		if (qefs) (*qefs)[leaf_idx] = vox_pq;
+	}
+}
 
-		if (s1 == s2) continue;*/
+void UOctreeCode::FinalizeLeafNodes(LeafIntersectionBatch& batch, const OctreeSettingsMultithreadContext& settings_context, const TArray<FSDFOp>* sdf_ops, const HermiteData* known_hermite, HermiteData* hermite)
+{
+#if USE_NAMED_STATS
+	QUICK_SCOPE_CYCLE_COUNTER(Stat_FinalizeLeafNodes)
+#endif
 
-		//detected sign change on current edge
-		FVector3f corner_1 = (child_offsets[edges_corner_map[idx][0]] * node_size * 0.5f) + node_center;
-		FVector3f corner_2 = (child_offsets[edges_corner_map[idx][1]] * node_size * 0.5f) + node_center;
+	if (batch.leaves.IsEmpty()) return;
 
-		float d1 = corner_densities[edges_corner_map[idx][0]] - iso_surface;
-		float d2 = corner_densities[edges_corner_map[idx][1]] - iso_surface;
+	//leaves are always placed at max depth
+	TArray<FVector3f> normals;
+	SampleIntersectionNormals(batch, batch.leaves[0]->size, settings_context, sdf_ops, known_hermite, normals);
 
-		// (1-alpha)*d1 + alpha*d2 = 0
-		// d1 - alpha*d1 + alpha*d2 = 0
-		// d1 + alpha(-d1+d2) = 0
-		// alpha = d1 / (d1-d2)
-		float alpha = d1 / (d1 - d2 + FLT_EPSILON);
+	if (hermite) AppendHermiteEdges(batch, normals, *hermite);
 
-		FVector3f intersection = FMath::Lerp(corner_1, corner_2, alpha);
-		//mass_point += intersection;
+	TArray<FVector3f> minimizers;
+	TArray<quadric3> qefs;
+	SolveLeafQEFs(batch, normals, settings_context, minimizers, &qefs);
 
-		//at 32 vox size, i dont think it's worth doing better zero crossing. below usually gives values in order of 0.001 > x > -0.001
-		//float alpha_density = noise_gen->GetNoiseSingle3D(intersection.X * scale_factor, intersection.Y * scale_factor, intersection.Z * scale_factor) - octree_settings->iso_surface;
+	int32 intersection_idx = 0;
+	for (int32 leaf_idx = 0; leaf_idx < batch.leaves.Num(); leaf_idx++)
+	{
+		OctreeNode* node = batch.leaves[leaf_idx];
+		const uint8 edge_count = batch.intersection_counts[leaf_idx];
 
-		FVector3f normal = FDMGetNormal_SDF(intersection * scale_factor, fdm_normal_offset, seed, sdf_ops);
-		vert_normal += normal;
+		FVector3f& vert_normal = node->leaf_data.normal;
+		vert_normal = FVector3f(0.f);
 
-		vox_pq += quadric3::probabilistic_plane_quadric(intersection * scale_factor, normal, stddev_pos, stddev_normal);
-		edge_count++;
-	}
+		for (uint8 e = 0; e < edge_count; e++, intersection_idx++)
+		{
+			vert_normal += normals[intersection_idx];
+		}
 
-	vert_normal /= edge_count;
+		vert_normal /= edge_count;
 
-	node->leaf_data.minimizer = vox_pq.minimizer();
+		node->leaf_data.qef = qefs[leaf_idx];
+		node->leaf_data.minimizer = minimizers[leaf_idx];
 
 #if CLAMP_MINIMIZERS
 
-	float half_size = node->size * 0.5f * scale_factor;
-	FVector3f scaled_center = node->center * scale_factor;
+		float half_size = node->size * 0.5f * scale_factor;
+		FVector3f scaled_center = node->center * scale_factor;
 
-	if (node->leaf_data->minimizer.X > scaled_center.X + half_size)
-	{
-		node->leaf_data->minimizer.X = scaled_center.X + half_size;
-	}
-	if (node->leaf_data->minimizer.Y > scaled_center.Y + half_size)
-	{
-		node->leaf_data->minimizer.Y = scaled_center.Y + half_size;
-	}
-	if (node->leaf_data->minimizer.Z > scaled_center.Z + half_size)
-	{
-		node->leaf_data->minimizer.Z = scaled_center.Z + half_size;
-	}
+		if (node->leaf_data.minimizer.X > scaled_center.X + half_size)
+		{
+			node->leaf_data.minimizer.X = scaled_center.X + half_size;
+		}
+		if (node->leaf_data.minimizer.Y > scaled_center.Y + half_size)
+		{
+			node->leaf_data.minimizer.Y = scaled_center.Y + half_size;
+		}
+		if (node->leaf_data.minimizer.Z > scaled_center.Z + half_size)
+		{
+			node->leaf_data.minimizer.Z = scaled_center.Z + half_size;
+		}
 
 
-	if (node->leaf_data->minimizer.X < scaled_center.X - half_size)
-	{
-		node->leaf_data->minimizer.X = scaled_center.X - half_size;
-	}
-	if (node->leaf_data->minimizer.Y < scaled_center.Y - half_size)
-	{
-		node->leaf_data->minimizer.Y = scaled_center.Y - half_size;
-	}
-	if (node->leaf_data->minimizer.Z < scaled_center.Z - half_size)
-	{
-		node->leaf_data->minimizer.Z = scaled_center.Z - half_size;
-	}
+		if (node->leaf_data.minimizer.X < scaled_center.X - half_size)
+		{
+			node->leaf_data.minimizer.X = scaled_center.X - half_size;
+		}
+		if (node->leaf_data.minimizer.Y < scaled_center.Y - half_size)
+		{
+			node->leaf_data.minimizer.Y = scaled_center.Y - half_size;
+		}
+		if (node->leaf_data.minimizer.Z < scaled_center.Z - half_size)
+		{
+			node->leaf_data.minimizer.Z = scaled_center.Z - half_size;
+		}
 #endif
 
 #if UE_BUILD_DEBUG
-	if (isnan(node->leaf_data->minimizer.X) || isnan(node->leaf_data->minimizer.Y) || isnan(node->leaf_data->minimizer.Z))
-	{
-		check(false);
-	}
+		if (isnan(node->leaf_data.minimizer.X) || isnan(node->leaf_data.minimizer.Y) || isnan(node->leaf_data.minimizer.Z))
+		{
+			check(false);
+		}
 #endif
+	}
 }
 
 #include "SeamRecursionFunctions.inl"
@@ -388,181 +530,914 @@ StitchOctreeNode* UOctreeCode::ConstructSeamOctree(const TArray<OctreeNode*, TIn
 	return stitch_root;
 }
 
-//constexpr unsigned char edges_corner_map[12][2] =
-//{
-//	{0, 1}, {1, 2}, {2, 3}, {3, 0},
-//	{4, 0}, {1, 5}, {2, 6}, {7, 3},
-//	{4, 5}, {5, 6}, {6, 7}, {7, 4}
-//};
-
+// every seam recursion function above descends into a fixed set of children on each level,
+// so for the linear octree one function driven by a child mask covers all of them.
+constexpr uint8 SEAM_LEFT = 0x0F;
+constexpr uint8 SEAM_RIGHT = 0xF0;
+constexpr uint8 SEAM_BACK = 0x55;
+constexpr uint8 SEAM_FRONT = 0xAA;
+constexpr uint8 SEAM_TOP = 0xCC;
+constexpr uint8 SEAM_BOTTOM = 0x33;
 
-TUniquePtr<OctreeNode> UOctreeCode::BuildOctree(FVector3f center, float size, const OctreeSettingsMultithreadContext& settings_context, const TArray<float>& noise)
+constexpr uint8 main_seam_masks[2][3] =
 {
-#if USE_NAMED_STATS
-	QUICK_SCOPE_CYCLE_COUNTER(Stat_BuildOctree)
-#endif
-
-	TUniquePtr<OctreeNode> root = MakeUniqueForOverwrite<OctreeNode>();
-	root->center = center;
-	root->depth = 0;
-	root->size = size;
+	{SEAM_LEFT, SEAM_BACK, SEAM_BOTTOM},
+	{SEAM_FRONT, SEAM_RIGHT, SEAM_TOP}
+};
 
-	int32 dim = GetDim(settings_context.max_depth)+1;
+// CornerMiniRecurse_7, CornerBarRecurseTR, CornerBarRecurseVRF, ... in the same order as other_seam_operations
+constexpr uint8 other_seam_masks[2][7] =
+{
+	{0x80, 0xC0, 0xA0, SEAM_RIGHT, 0x88, SEAM_TOP, SEAM_FRONT},
+	{SEAM_BACK, SEAM_BOTTOM, 0x11, SEAM_LEFT, 0x05, 0x03, 0x01}
+};
 
-	int32 vox_dim = dim-1;
-	float vox_size = size / vox_dim;
+static StitchOctreeNode* SeamRecurse(const LinearOctree* tree, uint32 node_idx, StitchOctreeNode* existing, uint8 child_select, MeshBuilder& builder)
+{
+	if (!tree || node_idx == INDEX_NOEXIST) return nullptr;
 
-	const float iso_surface = settings_context.iso_surface;
+	const OctreeNode_smol& node = tree->nodes[node_idx];
 
-	bool has_data = false;
+	bool did_exist = true;
+	if (!existing)
 	{
-#if USE_NAMED_STATS
-	QUICK_SCOPE_CYCLE_COUNTER(Stat_BuildOctee_voxbuilding)
-#endif
-	for (size_t x = 0; x < vox_dim; x++)
+		existing = new StitchOctreeNode();
+		existing->corners = node.corners;
+		existing->depth = node.depth;
+		existing->type = node.type;
+		did_exist = false;
+	}
+
+	if (node.type == NODE_INTERNAL)
 	{
-		for (size_t y = 0; y < vox_dim; y++)
+		for (uint8 i = 0; i < 8; i++)
 		{
-			for (size_t z = 0; z < vox_dim; z++)
-			{
-#if USE_NAMED_STATS
-				QUICK_SCOPE_CYCLE_COUNTER(Stat_BuildOctree_voxiteration)
-#endif
+			if (!((child_select >> i) & 1)) continue;
 
-				//FVector3f local_node_query_p = FVector3f(x * vox_size + vox_size * 0.5f, y * vox_size + vox_size * 0.5f, z * vox_size + vox_size * 0.5f);
-				FIntVector3 lc = FIntVector3(x, y, z);
+			existing->children[i] = SeamRecurse(tree, node.GetChildIndex(i), existing->children[i], child_select, builder);
+		}
+	}
+	else if (!did_exist)
+	{
+		const auto& vertex = builder.AddVertex(tree->minimizers[node.leaf_data_idx] * inv_scale_factor).SetNormal(tree->normals[node.leaf_data_idx]);
+		existing->tri_index = vertex.GetIndex();
+	}
 
-				int32 idx_table[8];
-				idx_table[0] = Get1DIndexFrom3D(lc.X, lc.Y, lc.Z, dim);
-				idx_table[1] = Get1DIndexFrom3D(lc.X + 1, lc.Y, lc.Z, dim);
-				idx_table[2] = Get1DIndexFrom3D(lc.X, lc.Y, lc.Z + 1, dim);
-				idx_table[3] = Get1DIndexFrom3D(lc.X + 1, lc.Y, lc.Z + 1, dim);
-				idx_table[4] = Get1DIndexFrom3D(lc.X, lc.Y + 1, lc.Z, dim);
-				idx_table[5] = Get1DIndexFrom3D(lc.X + 1, lc.Y + 1, lc.Z, dim);
-				idx_table[6] = Get1DIndexFrom3D(lc.X, lc.Y + 1, lc.Z + 1, dim);
-				idx_table[7] = Get1DIndexFrom3D(lc.X + 1, lc.Y + 1, lc.Z + 1, dim);
+	return existing;
+}
 
-				//TArray<float> corner_densities = SampleOctreeNodeDensities(node);
+StitchOctreeNode* UOctreeCode::ConstructSeamOctree(const TArray<const LinearOctree*, TInlineAllocator<8>>& seam_trees, bool nd, MeshBuilder& builder)
+{
+	//root of every tree is at index 0
+	const LinearOctree* main_tree = seam_trees[main_node[nd]];
 
-				const float corner_densities[8] = { noise[idx_table[0]], noise[idx_table[1]], noise[idx_table[2]],
-											  noise[idx_table[3]], noise[idx_table[4]], noise[idx_table[5]],
-											  noise[idx_table[6]], noise[idx_table[7]] };
+	StitchOctreeNode* stitch_main = SeamRecurse(main_tree, 0, nullptr, main_seam_masks[nd][0], builder);
+	SeamRecurse(main_tree, 0, stitch_main, main_seam_masks[nd][1], builder);
+	SeamRecurse(main_tree, 0, stitch_main, main_seam_masks[nd][2], builder);
 
+	StitchOctreeNode* stitch_root = new StitchOctreeNode();
+	stitch_root->type = NODE_INTERNAL;
+	stitch_root->depth = -1;
+	stitch_root->corners = 0;
 
-				int32 vox_idx = Get1DIndexFrom3D(x,y,z, vox_dim);
-				uint8 corners = 0;
-				for (uint8_t i = 0; i < 8; i++)
-				{
-					corners |= ((corner_densities[i] - iso_surface) <= 0.f) << i;
-				}
+	stitch_root->children[main_node[nd]] = stitch_main;
+	for (int32 i = 0; i < 7; i++)
+	{
+		stitch_root->children[other_nodes[nd][i]] = SeamRecurse(seam_trees[other_nodes[nd][i]], 0, nullptr, other_seam_masks[nd][i], builder);
+	}
 
-				FVector3f world_pos = FVector3f(x*vox_size + vox_size * 0.5f, y*vox_size + vox_size*0.5f, z*vox_size + vox_size * 0.5f) + (root->center-size*0.5f);
+	return stitch_root;
+}
 
-				if(corners != 255 && corners != 0)
-				{
-					has_data = true;
-					ConstructLeafNode(root.Get(), world_pos, corner_densities, corners, settings_context);
-				}
-			}
-		}
-	}
-	}
+//constexpr unsigned char edges_corner_map[12][2] =
+//{
+//	{0, 1}, {1, 2}, {2, 3}, {3, 0},
+//	{4, 0}, {1, 5}, {2, 6}, {7, 3},
+//	{4, 5}, {5, 6}, {6, 7}, {7, 4}
+//};
 
-	if(!has_data) return nullptr;
 
-	if(settings_context.simplify) SimplifyOctree(root.Get(), settings_context.simplify_threshold);
+OctreeNode* UOctreeCode::BuildOctree(FVector3f center, float size, const OctreeSettingsMultithreadContext& settings_context, const TArray<float>& noise, OctreeNodeArena& arena, HermiteData* hermite)
+{
+	return BuildOctreeFromNoise(center, size, settings_context, noise, nullptr, arena, hermite);
+}
 
-	return root;
+OctreeNode* UOctreeCode::RebuildOctree(FVector3f center, float size, const OctreeSettingsMultithreadContext& settings_context, const TArray<float>& noise, const TArray<FSDFOp>& sdf_ops, OctreeNodeArena& arena, HermiteData* hermite)
+{
+	return BuildOctreeFromNoise(center, size, settings_context, noise, &sdf_ops, arena, hermite);
 }
 
-TUniquePtr<OctreeNode> UOctreeCode::RebuildOctree(FVector3f center, float size, const OctreeSettingsMultithreadContext& settings_context, const TArray<float>& noise, const TArray<FSDFOp>& sdf_ops)
+OctreeNode* UOctreeCode::BuildOctreeFromNoise(FVector3f center, float size, const OctreeSettingsMultithreadContext& settings_context, const TArray<float>& noise, const TArray<FSDFOp>* sdf_ops, OctreeNodeArena& arena, HermiteData* hermite)
 {
 #if USE_NAMED_STATS
 	QUICK_SCOPE_CYCLE_COUNTER(Stat_BuildOctree)
 #endif
 
-	//possible replace with uniqueptr
-	TUniquePtr<OctreeNode> root = MakeUniqueForOverwrite<OctreeNode>();
+	OctreeNode* root = arena.Allocate();
 	root->center = center;
 	root->depth = 0;
 	root->size = size;
 
-	int32 dim = GetDim(settings_context.max_depth) + 1;
-
-	int32 vox_dim = dim - 1;
-	float vox_size = size / vox_dim;
+	SignPyramid pyramid;
+	BuildSignPyramid(noise, settings_context, pyramid);
 
-	const float iso_surface = settings_context.iso_surface;
+	//edges of the previous build are looked up, hermite is refilled with the edges of this one
+	HermiteData known_hermite;
+	if (hermite)
+	{
+		known_hermite = MoveTemp(*hermite);
+		hermite->Reset();
+	}
 
-	bool has_data = false;
+	if (settings_context.parallel_octant_build && settings_context.max_depth > 1)
 	{
-#if USE_NAMED_STATS
-		QUICK_SCOPE_CYCLE_COUNTER(Stat_BuildOctee_voxbuilding)
-#endif
-			for (size_t x = 0; x < vox_dim; x++)
-			{
-				for (size_t y = 0; y < vox_dim; y++)
-				{
-					for (size_t z = 0; z < vox_dim; z++)
-					{
-#if USE_NAMED_STATS
-						QUICK_SCOPE_CYCLE_COUNTER(Stat_BuildOctree_voxiteration)
-#endif
+		return BuildOctreeOctants(root, pyramid, settings_context, noise, sdf_ops, arena, &known_hermite, hermite);
+	}
 
-							//FVector3f local_node_query_p = FVector3f(x * vox_size + vox_size * 0.5f, y * vox_size + vox_size * 0.5f, z * vox_size + vox_size * 0.5f);
-							FIntVector3 lc = FIntVector3(x, y, z);
+	//first pass only places leaves and gathers edge intersections, normals are sampled for all of them at once afterwards
+	LeafIntersectionBatch batch;
 
-						int32 idx_table[8];
-						idx_table[0] = Get1DIndexFrom3D(lc.X, lc.Y, lc.Z, dim);
-						idx_table[1] = Get1DIndexFrom3D(lc.X + 1, lc.Y, lc.Z, dim);
-						idx_table[2] = Get1DIndexFrom3D(lc.X, lc.Y, lc.Z + 1, dim);
-						idx_table[3] = Get1DIndexFrom3D(lc.X + 1, lc.Y, lc.Z + 1, dim);
-						idx_table[4] = Get1DIndexFrom3D(lc.X, lc.Y + 1, lc.Z, dim);
-						idx_table[5] = Get1DIndexFrom3D(lc.X + 1, lc.Y + 1, lc.Z, dim);
-						idx_table[6] = Get1DIndexFrom3D(lc.X, lc.Y + 1, lc.Z + 1, dim);
-						idx_table[7] = Get1DIndexFrom3D(lc.X + 1, lc.Y + 1, lc.Z + 1, dim);
+	if (pyramid.IsActive(0, FIntVector3(0)))
+	{
+		ConstructLeafNodes(root, FIntVector3(0), pyramid, noise, settings_context, arena, batch);
+	}
 
-						//TArray<float> corner_densities = SampleOctreeNodeDensities(node);
+	if(batch.leaves.IsEmpty())
+	{
+		arena.Release();
+		return nullptr;
+	}
 
-						const float corner_densities[8] = { noise[idx_table[0]], noise[idx_table[1]], noise[idx_table[2]],
-													  noise[idx_table[3]], noise[idx_table[4]], noise[idx_table[5]],
-													  noise[idx_table[6]], noise[idx_table[7]] };
+	FinalizeLeafNodes(batch, settings_context, sdf_ops, &known_hermite, hermite);
+	if (hermite) hermite->Finalize();
 
+	if(settings_context.simplify)
+	{
+		if (settings_context.batched_qef) SimplifyOctreeBatched(root, settings_context.simplify_threshold, &arena);
+		else SimplifyOctree(root, settings_context.simplify_threshold);
+	}
+
+	return root;
+}
+
+OctreeNode* UOctreeCode::BuildOctreeOctants(OctreeNode* root, const SignPyramid& pyramid, const OctreeSettingsMultithreadContext& settings_context, const TArray<float>& noise, const TArray<FSDFOp>* sdf_ops, OctreeNodeArena& arena, const HermiteData* known_hermite, HermiteData* hermite)
+{
+#if USE_NAMED_STATS
+	QUICK_SCOPE_CYCLE_COUNTER(Stat_BuildOctreeOctants)
+#endif
+
+	HermiteData octant_hermite[8];
+
+	//every worker only writes its own child slot of root and the subtree below it
+	ForEachOctantParallel(arena, [&](int32 i, OctreeNodeArena& octant_arena)
+		{
+			const FIntVector3 octant_cell = FIntVector3(i & 1, (i >> 2) & 1, (i >> 1) & 1);
+			if (!pyramid.IsActive(1, octant_cell)) return;
+
+			OctreeNode* octant = octant_arena.Allocate();
+			octant->depth = 1;
+			octant->center = root->center + child_offsets[i] * root->size * 0.25f;
+			octant->size = root->size * 0.5f;
+			root->children[i] = octant;
+
+			LeafIntersectionBatch batch;
+			ConstructLeafNodes(octant, octant_cell, pyramid, noise, settings_context, octant_arena, batch);
+
+			FinalizeLeafNodes(batch, settings_context, sdf_ops, known_hermite, hermite ? &octant_hermite[i] : nullptr);
+
+			if (!settings_context.simplify) return;
+
+			if (settings_context.batched_qef) SimplifyOctreeBatched(octant, settings_context.simplify_threshold, &octant_arena);
+			else SimplifyOctree(octant, settings_context.simplify_threshold);
+		});
+
+	if (hermite)
+	{
+		for (HermiteData& octant_edges : octant_hermite)
+		{
+			hermite->edges.Append(MoveTemp(octant_edges.edges));
+		}
+		hermite->Finalize();
+	}
+
+	if (!root->children[0] && !root->children[1] && !root->children[2] && !root->children[3] &&
+		!root->children[4] && !root->children[5] && !root->children[6] && !root->children[7])
+	{
+		arena.Release();
+		return nullptr;
+	}
+
+	//the octants are final, what is left is stitching them at the root
+	if (settings_context.simplify) SimplifyOctreeNode(root, settings_context.simplify_threshold, &arena);
+
+	return root;
+}
+
+void UOctreeCode::BuildSignPyramid(const TArray<float>& noise, const OctreeSettingsMultithreadContext& settings_context, SignPyramid& pyramid)
+{
+#if USE_NAMED_STATS
+	QUICK_SCOPE_CYCLE_COUNTER(Stat_BuildSignPyramid)
+#endif
+
+	const int32 max_depth = settings_context.max_depth;
+	const int32 vox_dim = GetDim(max_depth);
+
+	pyramid.levels.SetNum(max_depth + 1);
+
+	ClassifyVoxels(noise, settings_context, FIntVector3(0), FIntVector3(vox_dim - 1), pyramid.active_cells, &pyramid.voxel_corners);
+
+	TArray<uint8>& voxel_level = pyramid.levels[max_depth];
+	voxel_level.SetNumZeroed(vox_dim * vox_dim * vox_dim);
+	for (const ActiveCell& cell : pyramid.active_cells)
+	{
+		voxel_level[cell.index] = 1;
+	}
+
+	//neighbouring voxels share corners, so a cell without any active voxel is entirely in or out
+	for (int32 depth = max_depth - 1; depth >= 0; depth--)
+	{
+		const int32 level_dim = GetDim(depth);
+		const TArray<uint8>& finer = pyramid.levels[depth + 1];
+		TArray<uint8>& level = pyramid.levels[depth];
+		level.SetNumUninitialized(level_dim * level_dim * level_dim);
+
+		for (int32 x = 0; x < level_dim; x++)
+		{
+			for (int32 y = 0; y < level_dim; y++)
+			{
+				for (int32 z = 0; z < level_dim; z++)
+				{
+					uint8 active = 0;
+					for (int32 i = 0; i < 8; i++)
+					{
+						active |= finer[Get1DIndexFrom3D(x * 2 + (i & 1), y * 2 + ((i >> 2) & 1), z * 2 + ((i >> 1) & 1), level_dim * 2)];
+					}
+					level[Get1DIndexFrom3D(x, y, z, level_dim)] = active;
+				}
+			}
+		}
+	}
+}
+
+void UOctreeCode::ConstructLeafNodes(OctreeNode* node, const FIntVector3& node_cell, const SignPyramid& pyramid, const TArray<float>& noise, const OctreeSettingsMultithreadContext& settings_context, OctreeNodeArena& arena, LeafIntersectionBatch& batch)
+{
+	const int32 max_depth = settings_context.max_depth;
+	const int32 child_depth = node->depth + 1;
+
+	for (int32 i = 0; i < 8; i++)
+	{
+		const FIntVector3 child_cell = node_cell * 2 + FIntVector3(i & 1, (i >> 2) & 1, (i >> 1) & 1);
+
+		//whole octant on one side of the surface
+		if (!pyramid.IsActive(child_depth, child_cell)) continue;
+
+		OctreeNode* child = arena.Allocate();
+		child->depth = child_depth;
+		child->center = node->center + child_offsets[i] * node->size * 0.25f;
+		child->size = node->size * 0.5f;
+		node->children[i] = child;
+
+		if (child_depth != max_depth)
+		{
+			ConstructLeafNodes(child, child_cell, pyramid, noise, settings_context, arena, batch);
+			continue;
+		}
+
+		const int32 vox_dim = GetDim(max_depth);
+
+		float corner_densities[8];
+		GatherCornerDensities(noise, child_cell, vox_dim + 1, corner_densities);
+
+		EmitLeafNode(child, child_cell, corner_densities, pyramid.voxel_corners[Get1DIndexFrom3D(child_cell.X, child_cell.Y, child_cell.Z, vox_dim)], settings_context, batch);
+	}
+}
+
+void UOctreeCode::ConstructLeafNodes(OctreeNode* root, const FIntVector3& vox_min, const FIntVector3& vox_max, const TArray<float>& noise, const OctreeSettingsMultithreadContext& settings_context, OctreeNodeArena& arena, LeafIntersectionBatch& batch)
+{
+#if USE_NAMED_STATS
+	QUICK_SCOPE_CYCLE_COUNTER(Stat_BuildOctee_voxbuilding)
+#endif
+
+	const int32 vox_dim = GetDim(settings_context.max_depth);
+	const float vox_size = root->size / vox_dim;
+	const FVector3f root_min = root->center - root->size * 0.5f;
+
+	TArray<ActiveCell> active_cells;
+	ClassifyVoxels(noise, settings_context, vox_min, vox_max, active_cells, nullptr);
+
+	for (const ActiveCell& cell : active_cells)
+	{
+		const FIntVector3 lc = FIntVector3(cell.index / (vox_dim * vox_dim), (cell.index / vox_dim) % vox_dim, cell.index % vox_dim);
+
+		float corner_densities[8];
+		GatherCornerDensities(noise, lc, vox_dim + 1, corner_densities);
+
+		const FVector3f world_pos = FVector3f(lc.X * vox_size + vox_size * 0.5f, lc.Y * vox_size + vox_size * 0.5f, lc.Z * vox_size + vox_size * 0.5f) + root_min;
+
+		ConstructLeafNode(root, world_pos, lc, corner_densities, cell.corners, settings_context, arena, batch);
+	}
+}
+
+void UOctreeCode::ClassifyVoxels(const TArray<float>& noise, const OctreeSettingsMultithreadContext& settings_context, const FIntVector3& vox_min, const FIntVector3& vox_max, TArray<ActiveCell>& active_cells, TArray<uint8>* voxel_corners)
+{
+#if USE_NAMED_STATS
+	QUICK_SCOPE_CYCLE_COUNTER(Stat_ClassifyVoxels)
+#endif
+
+	const int32 vox_dim = GetDim(settings_context.max_depth);
+	const int32 dim = vox_dim + 1;
 
-						int32 vox_idx = Get1DIndexFrom3D(x, y, z, vox_dim);
-						uint8 corners = 0;
-						for (uint8_t i = 0; i < 8; i++)
-						{
-							corners |= ((corner_densities[i] - iso_surface) <= 0.f) << i;
-						}
+	//samples of the box, z rows stay contiguous
+	const FIntVector3 sample_num = vox_max - vox_min + FIntVector3(2);
+	const int32 row_len = sample_num.Z;
+	const int32 vox_row_len = row_len - 1;
+
+	//one byte per sample, 1 for solid. 4 samples per compare
+	TArray<uint8> solid;
+	solid.SetNumUninitialized(sample_num.X * sample_num.Y * row_len);
+
+	const VectorRegister4Float iso_4 = VectorSetFloat1(settings_context.iso_surface);
+	for (int32 x = 0; x < sample_num.X; x++)
+	{
+		for (int32 y = 0; y < sample_num.Y; y++)
+		{
+			const float* src = noise.GetData() + Get1DIndexFrom3D(vox_min.X + x, vox_min.Y + y, vox_min.Z, dim);
+			uint8* dst = solid.GetData() + (x * sample_num.Y + y) * row_len;
+
+			int32 z = 0;
+			for (; z + 4 <= row_len; z += 4)
+			{
+				const int32 bits = VectorMaskBits(VectorCompareLE(VectorLoad(src + z), iso_4));
+				dst[z] = bits & 1;
+				dst[z + 1] = (bits >> 1) & 1;
+				dst[z + 2] = (bits >> 2) & 1;
+				dst[z + 3] = (bits >> 3) & 1;
+			}
+			for (; z < row_len; z++)
+			{
+				dst[z] = src[z] <= settings_context.iso_surface;
+			}
+		}
+	}
+
+	if (voxel_corners) voxel_corners->SetNumUninitialized(vox_dim * vox_dim * vox_dim);
+
+	TArray<uint8> row_corners;
+	row_corners.SetNumUninitialized(vox_row_len);
+
+	for (int32 x = 0; x < sample_num.X - 1; x++)
+	{
+		for (int32 y = 0; y < sample_num.Y - 1; y++)
+		{
+			const uint8* r00 = solid.GetData() + (x * sample_num.Y + y) * row_len;
+			const uint8* r10 = solid.GetData() + ((x + 1) * sample_num.Y + y) * row_len;
+			const uint8* r01 = solid.GetData() + (x * sample_num.Y + y + 1) * row_len;
+			const uint8* r11 = solid.GetData() + ((x + 1) * sample_num.Y + y + 1) * row_len;
+
+			//8 voxels at once, one per byte lane. lanes are 0 or 1 so the shifts never carry into the next lane
+			int32 z = 0;
+			for (; z + 8 <= vox_row_len; z += 8)
+			{
+				uint64 a0, a1, b0, b1, c0, c1, d0, d1;
+				FMemory::Memcpy(&a0, r00 + z, 8); FMemory::Memcpy(&a1, r00 + z + 1, 8);
+				FMemory::Memcpy(&b0, r10 + z, 8); FMemory::Memcpy(&b1, r10 + z + 1, 8);
+				FMemory::Memcpy(&c0, r01 + z, 8); FMemory::Memcpy(&c1, r01 + z + 1, 8);
+				FMemory::Memcpy(&d0, r11 + z, 8); FMemory::Memcpy(&d1, r11 + z + 1, 8);
+
+				const uint64 corners = a0 | (b0 << 1) | (a1 << 2) | (b1 << 3) | (c0 << 4) | (d0 << 5) | (c1 << 6) | (d1 << 7);
+				FMemory::Memcpy(row_corners.GetData() + z, &corners, 8);
+			}
+			for (; z < vox_row_len; z++)
+			{
+				row_corners[z] = r00[z] | (r10[z] << 1) | (r00[z + 1] << 2) | (r10[z + 1] << 3) | (r01[z] << 4) | (r11[z] << 5) | (r01[z + 1] << 6) | (r11[z + 1] << 7);
+			}
+
+			const int32 row_start = Get1DIndexFrom3D(vox_min.X + x, vox_min.Y + y, vox_min.Z, vox_dim);
+			if (voxel_corners) FMemory::Memcpy(voxel_corners->GetData() + row_start, row_corners.GetData(), vox_row_len);
+
+			for (z = 0; z < vox_row_len; z++)
+			{
+				const uint8 corners = row_corners[z];
+				if (corners == 0 || corners == 255) continue;
+
+				active_cells.Add(ActiveCell{row_start + z, corners, edge_mask_table.masks[corners]});
+			}
+		}
+	}
+}
+
+//voxel box helpers for region rebuilds, boxes are inclusive
+static FORCEINLINE bool VoxelBoxesOverlap(const FIntVector3& a_min, const FIntVector3& a_max, const FIntVector3& b_min, const FIntVector3& b_max)
+{
+	return a_min.X <= b_max.X && b_min.X <= a_max.X && a_min.Y <= b_max.Y && b_min.Y <= a_max.Y && a_min.Z <= b_max.Z && b_min.Z <= a_max.Z;
+}
+
+static FORCEINLINE FIntVector3 VoxelMin(const FIntVector3& a, const FIntVector3& b)
+{
+	return FIntVector3(FMath::Min(a.X, b.X), FMath::Min(a.Y, b.Y), FMath::Min(a.Z, b.Z));
+}
+
+static FORCEINLINE FIntVector3 VoxelMax(const FIntVector3& a, const FIntVector3& b)
+{
+	return FIntVector3(FMath::Max(a.X, b.X), FMath::Max(a.Y, b.Y), FMath::Max(a.Z, b.Z));
+}
+
+OctreeNode* UOctreeCode::RebuildOctreeRegion(OctreeNode* root, FVector3f center, float size, const OctreeSettingsMultithreadContext& settings_context, const TArray<float>& noise, const TArray<FSDFOp>& sdf_ops, const FBox3f& region, OctreeNodeArena& arena, HermiteData* hermite)
+{
+#if USE_NAMED_STATS
+	QUICK_SCOPE_CYCLE_COUNTER(Stat_RebuildOctreeRegion)
+#endif
+
+	const int32 vox_dim = GetDim(settings_context.max_depth);
+	const float vox_size = size / vox_dim;
+	const FVector3f chunk_min = center - size * 0.5f;
+
+	//voxels with a corner sample inside the region, one voxel of slack for rounding
+	const FVector3f region_min_f = (region.Min - chunk_min) / vox_size;
+	const FVector3f region_max_f = (region.Max - chunk_min) / vox_size;
+	const FIntVector3 region_min = VoxelMax(FIntVector3(FMath::FloorToInt(region_min_f.X), FMath::FloorToInt(region_min_f.Y), FMath::FloorToInt(region_min_f.Z)) - FIntVector3(1), FIntVector3(0));
+	const FIntVector3 region_max = VoxelMin(FIntVector3(FMath::FloorToInt(region_max_f.X), FMath::FloorToInt(region_max_f.Y), FMath::FloorToInt(region_max_f.Z)) + FIntVector3(1), FIntVector3(vox_dim - 1));
+
+	if (region_min.X > region_max.X || region_min.Y > region_max.Y || region_min.Z > region_max.Z) return root;
+
+	if (!root)
+	{
+		root = arena.Allocate();
+		root->center = center;
+		root->depth = 0;
+		root->size = size;
+	}
+
+	//cut out every cell touching the region, (collapsed) leaves are rebuilt over their whole cell
+	TArray<TPair<FIntVector3, FIntVector3>> rebuild_boxes;
+	DetachOctreeRegion(root, FIntVector3(0), vox_dim, region_min, region_max, arena, rebuild_boxes);
+
+	FIntVector3 dirty_min = region_min;
+	FIntVector3 dirty_max = region_max;
+
+	if (settings_context.parallel_octant_build && settings_context.max_depth > 1)
+	{
+		for (const TPair<FIntVector3, FIntVector3>& box : rebuild_boxes)
+		{
+			dirty_min = VoxelMin(dirty_min, box.Key);
+			dirty_max = VoxelMax(dirty_max, box.Value);
+		}
+
+		return RebuildOctreeRegionOctants(root, settings_context, noise, sdf_ops, rebuild_boxes, dirty_min, dirty_max, arena, hermite);
+	}
+
+	LeafIntersectionBatch batch;
+	for (const TPair<FIntVector3, FIntVector3>& box : rebuild_boxes)
+	{
+		ConstructLeafNodes(root, box.Key, box.Value, noise, settings_context, arena, batch);
+
+		dirty_min = VoxelMin(dirty_min, box.Key);
+		dirty_max = VoxelMax(dirty_max, box.Value);
+	}
+
+	//the noise inside the boxes changed, none of their old edges can be reused
+	HermiteData rebuilt_hermite;
+	FinalizeLeafNodes(batch, settings_context, &sdf_ops, nullptr, hermite ? &rebuilt_hermite : nullptr);
+	if (hermite) hermite->ReplaceRegion(MoveTemp(rebuilt_hermite), rebuild_boxes, vox_dim);
+
+	if (!PruneOctreeRegion(root, FIntVector3(0), vox_dim, dirty_min, dirty_max, arena))
+	{
+		arena.Release();
+		return nullptr;
+	}
+
+	if (settings_context.simplify) SimplifyOctreeRegion(root, FIntVector3(0), vox_dim, dirty_min, dirty_max, settings_context.simplify_threshold, arena);
+
+	return root;
+}
+
+OctreeNode* UOctreeCode::RebuildOctreeRegionOctants(OctreeNode* root, const OctreeSettingsMultithreadContext& settings_context, const TArray<float>& noise, const TArray<FSDFOp>& sdf_ops, const TArray<TPair<FIntVector3, FIntVector3>>& rebuild_boxes, const FIntVector3& dirty_min, const FIntVector3& dirty_max, OctreeNodeArena& arena, HermiteData* hermite)
+{
+#if USE_NAMED_STATS
+	QUICK_SCOPE_CYCLE_COUNTER(Stat_RebuildOctreeRegionOctants)
+#endif
+
+	const int32 octant_extent = GetDim(settings_context.max_depth) / 2;
+
+	HermiteData octant_hermite[8];
+
+	//octants the rebuild reaches get their node up front, so workers never write to root itself
+	uint8 octant_mask = 0;
+	for (int32 i = 0; i < 8; i++)
+	{
+		const FIntVector3 octant_min = FIntVector3(i & 1, (i >> 2) & 1, (i >> 1) & 1) * octant_extent;
+		const FIntVector3 octant_max = octant_min + FIntVector3(octant_extent - 1);
+
+		if (!VoxelBoxesOverlap(octant_min, octant_max, dirty_min, dirty_max)) continue;
+
+		octant_mask |= 1 << i;
+
+		if (root->children[i]) continue;
+
+		OctreeNode* octant = arena.Allocate();
+		octant->depth = 1;
+		octant->center = root->center + child_offsets[i] * root->size * 0.25f;
+		octant->size = root->size * 0.5f;
+		root->children[i] = octant;
+	}
+
+	ForEachOctantParallel(arena, [&](int32 i, OctreeNodeArena& octant_arena)
+		{
+			if (!((octant_mask >> i) & 1)) return;
+
+			const FIntVector3 octant_min = FIntVector3(i & 1, (i >> 2) & 1, (i >> 1) & 1) * octant_extent;
+			const FIntVector3 octant_max = octant_min + FIntVector3(octant_extent - 1);
+
+			LeafIntersectionBatch batch;
+			for (const TPair<FIntVector3, FIntVector3>& box : rebuild_boxes)
+			{
+				if (!VoxelBoxesOverlap(octant_min, octant_max, box.Key, box.Value)) continue;
+
+				//leaves of the clipped box all sit below root->children[i]
+				ConstructLeafNodes(root, VoxelMax(box.Key, octant_min), VoxelMin(box.Value, octant_max), noise, settings_context, octant_arena, batch);
+			}
+
+			FinalizeLeafNodes(batch, settings_context, &sdf_ops, nullptr, hermite ? &octant_hermite[i] : nullptr);
+
+			if (!PruneOctreeRegion(root->children[i], octant_min, octant_extent, dirty_min, dirty_max, octant_arena))
+			{
+				root->children[i] = nullptr;
+				return;
+			}
+
+			if (settings_context.simplify) SimplifyOctreeRegion(root->children[i], octant_min, octant_extent, dirty_min, dirty_max, settings_context.simplify_threshold, octant_arena);
+		});
+
+	if (hermite)
+	{
+		HermiteData rebuilt_hermite;
+		for (HermiteData& octant_edges : octant_hermite)
+		{
+			rebuilt_hermite.edges.Append(MoveTemp(octant_edges.edges));
+		}
+		hermite->ReplaceRegion(MoveTemp(rebuilt_hermite), rebuild_boxes, octant_extent * 2);
+	}
+
+	if (!root->children[0] && !root->children[1] && !root->children[2] && !root->children[3] &&
+		!root->children[4] && !root->children[5] && !root->children[6] && !root->children[7])
+	{
+		arena.Release();
+		return nullptr;
+	}
+
+	if (settings_context.simplify)
+	{
+		root->leaf_data = OctreeNode::DC_LeafData();
+		SimplifyOctreeNode(root, settings_context.simplify_threshold, &arena);
+	}
+
+	return root;
+}
+
+void UOctreeCode::DetachOctreeRegion(OctreeNode* node, const FIntVector3& node_min, int32 node_extent, const FIntVector3& region_min, const FIntVector3& region_max, OctreeNodeArena& arena, TArray<TPair<FIntVector3, FIntVector3>>& rebuild_boxes)
+{
+	const FIntVector3 node_max = node_min + FIntVector3(node_extent - 1);
+
+	if (!VoxelBoxesOverlap(node_min, node_max, region_min, region_max)) return;
+
+	const bool contained = VoxelMin(node_min, region_min) == region_min && VoxelMax(node_max, region_max) == region_max;
+
+	if (node->type != NODE_INTERNAL || contained)
+	{
+		for (int32 i = 0; i < 8; i++)
+		{
+			arena.FreeSubtree(node->children[i]);
+			node->children[i] = nullptr;
+		}
+
+		node->type = NODE_INTERNAL;
+		node->corners = 0;
+		node->leaf_data = OctreeNode::DC_LeafData();
+
+		rebuild_boxes.Emplace(node_min, node_max);
+		return;
+	}
+
+	const int32 child_extent = node_extent / 2;
+	for (int32 i = 0; i < 8; i++)
+	{
+		const FIntVector3 child_min = node_min + FIntVector3(i & 1, (i >> 2) & 1, (i >> 1) & 1) * child_extent;
+
+		if (node->children[i])
+		{
+			DetachOctreeRegion(node->children[i], child_min, child_extent, region_min, region_max, arena, rebuild_boxes);
+		}
+		else
+		{
+			//nothing was here yet, only the part inside the region can have changed
+			const FIntVector3 child_max = child_min + FIntVector3(child_extent - 1);
+			if (VoxelBoxesOverlap(child_min, child_max, region_min, region_max))
+			{
+				rebuild_boxes.Emplace(VoxelMax(child_min, region_min), VoxelMin(child_max, region_max));
+			}
+		}
+	}
+}
+
+bool UOctreeCode::PruneOctreeRegion(OctreeNode* node, const FIntVector3& node_min, int32 node_extent, const FIntVector3& region_min, const FIntVector3& region_max, OctreeNodeArena& arena)
+{
+	if (node->type != NODE_INTERNAL) return true;
+	if (!VoxelBoxesOverlap(node_min, node_min + FIntVector3(node_extent - 1), region_min, region_max)) return true;
+
+	bool has_children = false;
+	const int32 child_extent = node_extent / 2;
+	for (int32 i = 0; i < 8; i++)
+	{
+		if (!node->children[i]) continue;
+
+		const FIntVector3 child_min = node_min + FIntVector3(i & 1, (i >> 2) & 1, (i >> 1) & 1) * child_extent;
+		if (PruneOctreeRegion(node->children[i], child_min, child_extent, region_min, region_max, arena))
+		{
+			has_children = true;
+		}
+		else
+		{
+			node->children[i] = nullptr;
+		}
+	}
+
+	if (has_children) return true;
+
+	arena.Free(node);
+	return false;
+}
+
+bool UOctreeCode::SimplifyOctreeRegion(OctreeNode* node, const FIntVector3& node_min, int32 node_extent, const FIntVector3& region_min, const FIntVector3& region_max, float simplify_threshold, OctreeNodeArena& arena)
+{
+	if (!node) return false;
+
+	//cells outside the region keep the result of their last simplification
+	if (!VoxelBoxesOverlap(node_min, node_min + FIntVector3(node_extent - 1), region_min, region_max)) return true;
+
+	if (node->type) return true;
+
+	//SimplifyOctree accumulates into the internal node's leaf data, start over
+	node->leaf_data = OctreeNode::DC_LeafData();
+
+	const int32 child_extent = node_extent / 2;
+	for (int32 i = 0; i < 8; i++)
+	{
+		const FIntVector3 child_min = node_min + FIntVector3(i & 1, (i >> 2) & 1, (i >> 1) & 1) * child_extent;
+		SimplifyOctreeRegion(node->children[i], child_min, child_extent, region_min, region_max, simplify_threshold, arena);
+	}
+
+	//children are final now, this only decides the collapse of node itself
+	return SimplifyOctreeNode(node, simplify_threshold, &arena);
+}
+
+void UOctreeCode::BuildOctree(FVector3f center, float size, const OctreeSettingsMultithreadContext& settings_context, const TArray<float>& noise, LinearOctree& tree, HermiteData* hermite)
+{
+	//the pointer octree is only scaffolding here, it is released once linearized
+	OctreeNodeArena arena;
+
+	//octant workers simplify their own subtree, the linear pass would run serially
+	OctreeSettingsMultithreadContext build_context = settings_context;
+	build_context.simplify = settings_context.simplify && settings_context.parallel_octant_build;
+
+	LinearizeOctree(BuildOctree(center, size, build_context, noise, arena, hermite), tree);
+
+	if (settings_context.simplify && !build_context.simplify && !tree.IsEmpty())
+	{
+		if (settings_context.batched_qef) SimplifyOctreeBatched(tree, settings_context.simplify_threshold);
+		else SimplifyOctree(tree, settings_context.simplify_threshold);
+	}
+}
+
+void UOctreeCode::RebuildOctree(FVector3f center, float size, const OctreeSettingsMultithreadContext& settings_context, const TArray<float>& noise, const TArray<FSDFOp>& sdf_ops, LinearOctree& tree, HermiteData* hermite)
+{
+	OctreeNodeArena arena;
+
+	//octant workers simplify their own subtree, the linear pass would run serially
+	OctreeSettingsMultithreadContext build_context = settings_context;
+	build_context.simplify = settings_context.simplify && settings_context.parallel_octant_build;
+
+	LinearizeOctree(RebuildOctree(center, size, build_context, noise, sdf_ops, arena, hermite), tree);
+
+	if (settings_context.simplify && !build_context.simplify && !tree.IsEmpty())
+	{
+		if (settings_context.batched_qef) SimplifyOctreeBatched(tree, settings_context.simplify_threshold);
+		else SimplifyOctree(tree, settings_context.simplify_threshold);
+	}
+}
+
+void UOctreeCode::BuildProgressiveOctree(FVector3f center, float size, const OctreeSettingsMultithreadContext& settings_context, const TArray<float>& noise, const TArray<FSDFOp>* sdf_ops, ProgressiveOctree& progressive, HermiteData* hermite)
+{
+#if USE_NAMED_STATS
+	QUICK_SCOPE_CYCLE_COUNTER(Stat_BuildProgressiveOctree)
+#endif
+
+	progressive.Reset();
+
+	OctreeNodeArena arena;
+
+	//nothing is collapsed while building, the collapses are only recorded
+	OctreeSettingsMultithreadContext build_context = settings_context;
+	build_context.simplify = false;
+
+	LinearizeOctree(BuildOctreeFromNoise(center, size, build_context, noise, sdf_ops, arena, hermite), progressive.tree);
+
+	if (!progressive.IsEmpty()) FinalizeProgressiveOctree(progressive, settings_context.batched_qef);
+}
+
+void UOctreeCode::ExtractOctree(const ProgressiveOctree& progressive, const OctreeSettingsMultithreadContext& settings_context, int32 depth_cut, LinearOctree& tree)
+{
+#if USE_NAMED_STATS
+	QUICK_SCOPE_CYCLE_COUNTER(Stat_ExtractOctree)
+#endif
+
+	tree.Reset();
+
+	if (progressive.IsEmpty()) return;
+
+	const LinearOctree& source = progressive.tree;
+	//collapse errors are never negative, nothing but the depth cut collapses without simplification
+	const float threshold = settings_context.simplify ? settings_context.simplify_threshold : -1.f;
+
+	tree.nodes.Reserve(source.nodes.Num());
+
+	//same breadth first rewrite as CompactOctree, nodes within the cut are emitted as collapsed leaves
+	TArray<uint32> sources;
+	sources.Add(0);
+
+	for (int32 i = 0; i < sources.Num(); i++)
+	{
+		const OctreeNode_smol& source_node = source.nodes[sources[i]];
+		OctreeNode_smol node = source_node;
+
+		const bool collapse = source_node.type == NODE_INTERNAL && (source_node.depth >= depth_cut || progressive.collapse_errors[source_node.leaf_data_idx] <= threshold);
+
+		if (source_node.type == NODE_INTERNAL && !collapse)
+		{
+			node.first_child = sources.Num();
+			node.leaf_data_idx = INDEX_NOEXIST;
+
+			for (uint8 child = 0; child < 8; child++)
+			{
+				if (source_node.ChildExists(child)) sources.Add(source_node.GetChildIndex_Unchecked(child));
+			}
+		}
+		else
+		{
+			if (collapse)
+			{
+				node.type = NODE_COLLAPSED_LEAF;
+				node.corners = progressive.collapse_corners[source_node.leaf_data_idx];
+			}
+
+			node.first_child = INDEX_NOEXIST;
+			node.child_mask = 0;
+			node.leaf_data_idx = tree.minimizers.Num();
+
+			tree.minimizers.Add(source.minimizers[source_node.leaf_data_idx]);
+			tree.normals.Add(source.normals[source_node.leaf_data_idx]);
+			tree.qefs.Add(source.qefs[source_node.leaf_data_idx]);
+		}
+
+		tree.nodes.Add(node);
+	}
+}
+
+void UOctreeCode::BuildUniformLeafGrid(FVector3f center, float size, const OctreeSettingsMultithreadContext& settings_context, const TArray<float>& noise, const TArray<FSDFOp>* sdf_ops, UniformLeafGrid& grid, HermiteData* hermite)
+{
+#if USE_NAMED_STATS
+	QUICK_SCOPE_CYCLE_COUNTER(Stat_BuildUniformLeafGrid)
+#endif
+
+	grid.Reset();
+
+	const int32 vox_dim = GetDim(settings_context.max_depth);
+	const float vox_size = size / vox_dim;
+	const FVector3f chunk_min = center - size * 0.5f;
+
+	//the whole chunk in one box, active cells come out in ascending voxel index order which is the vertex order
+	TArray<ActiveCell> active_cells;
+	ClassifyVoxels(noise, settings_context, FIntVector3(0), FIntVector3(vox_dim - 1), active_cells, nullptr);
+
+	if (active_cells.IsEmpty())
+	{
+		if (hermite) hermite->Reset();
+		return;
+	}
+
+	grid.dim = vox_dim;
+	grid.active_words.SetNumZeroed((vox_dim * vox_dim * vox_dim + 63) / 64);
+	grid.word_offsets.SetNumUninitialized(grid.active_words.Num());
+	grid.corners.SetNumUninitialized(active_cells.Num());
+
+	LeafIntersectionBatch batch;
+	batch.intersection_counts.SetNumUninitialized(active_cells.Num());
+	batch.intersections.Reserve(active_cells.Num() * 3);
+	batch.edges.Reserve(active_cells.Num() * 3);
+
+	for (int32 i = 0; i < active_cells.Num(); i++)
+	{
+		const ActiveCell& cell = active_cells[i];
+
+		grid.active_words[cell.index >> 6] |= 1ull << (cell.index & 63);
+		grid.corners[i] = cell.corners;
+
+		const FIntVector3 lc = FIntVector3(cell.index / (vox_dim * vox_dim), (cell.index / vox_dim) % vox_dim, cell.index % vox_dim);
+
+		float corner_densities[8];
+		GatherCornerDensities(noise, lc, vox_dim + 1, corner_densities);
+
+		const FVector3f vox_center = FVector3f(lc.X * vox_size + vox_size * 0.5f, lc.Y * vox_size + vox_size * 0.5f, lc.Z * vox_size + vox_size * 0.5f) + chunk_min;
+
+		batch.intersection_counts[i] = static_cast<uint8>(FMath::CountBits(cell.edge_mask));
+		AppendEdgeIntersections(vox_center, vox_size, lc, vox_dim + 1, corner_densities, cell.corners, settings_context.iso_surface, batch);
+	}
+
+	uint32 offset = 0;
+	for (int32 w = 0; w < grid.active_words.Num(); w++)
+	{
+		grid.word_offsets[w] = offset;
+		offset += static_cast<uint32>(FMath::CountBits(grid.active_words[w]));
+	}
+
+	TArray<FVector3f> normals;
+	SampleIntersectionNormals(batch, vox_size, settings_context, sdf_ops, hermite, normals);
+	SolveLeafQEFs(batch, normals, settings_context, grid.minimizers, nullptr);
+
+	if (hermite)
+	{
+		hermite->Reset();
+		AppendHermiteEdges(batch, normals, *hermite);
+		hermite->Finalize();
+	}
+
+	grid.normals.SetNumUninitialized(active_cells.Num());
+
+	int32 intersection_idx = 0;
+	for (int32 i = 0; i < active_cells.Num(); i++)
+	{
+		FVector3f vert_normal = FVector3f(0.f);
+		for (uint8 e = 0; e < batch.intersection_counts[i]; e++, intersection_idx++)
+		{
+			vert_normal += normals[intersection_idx];
+		}
+
+		grid.normals[i] = vert_normal / batch.intersection_counts[i];
+	}
+}
+
+RealtimeMesh::FRealtimeMeshStreamSet UOctreeCode::PolygonizeInterior(OctreeNode* root)
+{
+#if USE_NAMED_STATS
+	QUICK_SCOPE_CYCLE_COUNTER(Stat_PolygonizeInterior)
+#endif
+
+	RealtimeMesh::FRealtimeMeshStreamSet stream_set;
+	RealtimeMesh::TRealtimeMeshBuilderLocal<uint32, FPackedNormal, FVector2DHalf, 1> builder(stream_set);
+	builder.EnableTangents();
+
+	BuildMeshData(root, builder);
+	DC_ProcessCell(root, builder);
+
+	return stream_set;
+}
 
-						FVector3f world_pos = FVector3f(x * vox_size + vox_size * 0.5f, y * vox_size + vox_size * 0.5f, z * vox_size + vox_size * 0.5f) + (root->center - size * 0.5f);
+RealtimeMesh::FRealtimeMeshStreamSet UOctreeCode::PolygonizeInterior(const LinearOctree& tree)
+{
+#if USE_NAMED_STATS
+	QUICK_SCOPE_CYCLE_COUNTER(Stat_PolygonizeInterior)
+#endif
 
-						if (corners != 255 && corners != 0)
-						{
-							has_data = true;
-							ConstructLeafNode_Edit(root.Get(), world_pos, corner_densities, corners, settings_context, sdf_ops);
-						}
-					}
-				}
-			}
-	}
-	//ConstructChildNodes(root, size, noise, root_min, );
-	if(!has_data) return nullptr;
+	RealtimeMesh::FRealtimeMeshStreamSet stream_set;
+	RealtimeMesh::TRealtimeMeshBuilderLocal<uint32, FPackedNormal, FVector2DHalf, 1> builder(stream_set);
+	builder.EnableTangents();
 
-	if (settings_context.simplify) SimplifyOctree(root.Get(), settings_context.simplify_threshold);
+	BuildMeshData(tree, builder);
+	DC_ProcessCell(tree, 0, builder);
 
-	return root;
+	return stream_set;
 }
 
-RealtimeMesh::FRealtimeMeshStreamSet UOctreeCode::PolygonizeOctree(const TArray<OctreeNode*, TInlineAllocator<8>>& nodes, bool negative_delta)
+RealtimeMesh::FRealtimeMeshStreamSet UOctreeCode::PolygonizeInterior(const UniformLeafGrid& grid)
 {
+#if USE_NAMED_STATS
+	QUICK_SCOPE_CYCLE_COUNTER(Stat_PolygonizeInterior)
+#endif
+
 	RealtimeMesh::FRealtimeMeshStreamSet stream_set;
 	RealtimeMesh::TRealtimeMeshBuilderLocal<uint32, FPackedNormal, FVector2DHalf, 1> builder(stream_set);
 	builder.EnableTangents();
 
-	BuildMeshData(nodes[main_node[negative_delta]], builder);
-	DC_ProcessCell(nodes[main_node[negative_delta]], builder);
+	BuildMeshData(grid, builder);
+	DC_ProcessGrid(grid, builder);
+
+	return stream_set;
+}
+
+RealtimeMesh::FRealtimeMeshStreamSet UOctreeCode::PolygonizeSeam(const TArray<OctreeNode*, TInlineAllocator<8>>& nodes, bool negative_delta)
+{
+	RealtimeMesh::FRealtimeMeshStreamSet stream_set;
+	RealtimeMesh::TRealtimeMeshBuilderLocal<uint32, FPackedNormal, FVector2DHalf, 1> builder(stream_set);
+	builder.EnableTangents();
 
 	StitchOctreeNode* stitch = ConstructSeamOctree(nodes, negative_delta, builder);
 
@@ -573,26 +1448,28 @@ RealtimeMesh::FRealtimeMeshStreamSet UOctreeCode::PolygonizeOctree(const TArray<
 	return stream_set;
 }
 
-RealtimeMesh::FRealtimeMeshStreamSet UOctreeCode::PolygonizeOctree(const TArray<OctreeNode*, TInlineAllocator<8>>& nodes, const TArray<OctreeNode*, TInlineAllocator<8>>& ec_nodes, bool negative_delta)
+RealtimeMesh::FRealtimeMeshStreamSet UOctreeCode::PolygonizeSeam(const TArray<const LinearOctree*, TInlineAllocator<8>>& trees, bool negative_delta)
 {
 	RealtimeMesh::FRealtimeMeshStreamSet stream_set;
 	RealtimeMesh::TRealtimeMeshBuilderLocal<uint32, FPackedNormal, FVector2DHalf, 1> builder(stream_set);
 	builder.EnableTangents();
 
-	BuildMeshData(nodes[main_node[negative_delta]], builder);
-	DC_ProcessCell(nodes[main_node[negative_delta]], builder);
-
-	StitchOctreeNode* stitch = ConstructSeamOctree(nodes, negative_delta, builder);
+	StitchOctreeNode* stitch = ConstructSeamOctree(trees, negative_delta, builder);
 
 	DC_ProcessCell(stitch, builder);
 
 	delete stitch;
 
-	StitchOctreeNode* ec_stitch = ConstructSeamOctree(ec_nodes, !negative_delta, builder);
+	return stream_set;
+}
 
-	DC_ProcessCell(ec_stitch, builder);
+RealtimeMesh::FRealtimeMeshStreamSet UOctreeCode::PolygonizeSeam(const TArray<const UniformLeafGrid*, TInlineAllocator<8>>& grids, bool negative_delta)
+{
+	RealtimeMesh::FRealtimeMeshStreamSet stream_set;
+	RealtimeMesh::TRealtimeMeshBuilderLocal<uint32, FPackedNormal, FVector2DHalf, 1> builder(stream_set);
+	builder.EnableTangents();
 
-	delete ec_stitch;
+	DC_ProcessGridSeam(grids, negative_delta, builder);
 
 	return stream_set;
 }
@@ -603,7 +1480,17 @@ bool UOctreeCode::SimplifyOctree(OctreeNode* node, float simplify_threshold)
 
 	//cant simplify if this node is a leaf / collapsed leaf
 	if(node->type) return true;
-	
+
+	for (uint8 i = 0; i < 8; i++)
+	{
+		SimplifyOctree(node->children[i], simplify_threshold);
+	}
+
+	return SimplifyOctreeNode(node, simplify_threshold);
+}
+
+bool UOctreeCode::SimplifyOctreeNode(OctreeNode* node, float simplify_threshold, OctreeNodeArena* arena)
+{
 	bool simplify = true;
 	unsigned char corners = 0;
 	unsigned char unset_corners = 0;
@@ -614,7 +1501,7 @@ bool UOctreeCode::SimplifyOctree(OctreeNode* node, float simplify_threshold)
 
 	for (uint8 i = 0; i < 8; i++)
 	{
-		if(SimplifyOctree(node->children[i].Get(), simplify_threshold)) // returns true if node exists
+		if(node->children[i])
 		{
 			mid_sign = (node->children[i]->corners >> (7 - i)) & 1;
 			if (!simplify) continue;
@@ -658,6 +1545,7 @@ bool UOctreeCode::SimplifyOctree(OctreeNode* node, float simplify_threshold)
 	node->corners = corners;
 	node->leaf_data.minimizer = minimizer;
 	avg_normal /= static_cast<float>(count);
+	node->leaf_data.normal = avg_normal;
 
 #if UE_BUILD_DEBUG
 	if(isnan(node->leaf_data->minimizer.X) || isnan(node->leaf_data->minimizer.Y) || isnan(node->leaf_data->minimizer.Z))
@@ -666,14 +1554,543 @@ bool UOctreeCode::SimplifyOctree(OctreeNode* node, float simplify_threshold)
 	}
 #endif
 
-	for (size_t i = 0; i < 8; i++)
-	{
-		/*delete node->children[i];
-		node->children[i] = nullptr;*/
-		node->children[i].Reset();
-	}
+	//collapsed children stay in the arena until the whole tree is released, unless they can go back to its free list
+	for (size_t i = 0; i < 8; i++)
+	{
+		if (arena && node->children[i]) arena->Free(node->children[i]);
+		node->children[i] = nullptr;
+	}
+
+	return true;
+}
+
+void UOctreeCode::SimplifyOctree(LinearOctree& tree, float simplify_threshold)
+{
+#if USE_NAMED_STATS
+	QUICK_SCOPE_CYCLE_COUNTER(Stat_SimplifyLinearOctree)
+#endif
+
+	bool collapsed_any = false;
+
+	//children are always stored after their parent, so walking backwards visits them first, same as the recursive version
+	for (int32 node_idx = tree.nodes.Num() - 1; node_idx >= 0; node_idx--)
+	{
+		OctreeNode_smol& node = tree.nodes[node_idx];
+
+		if (node.type) continue;
+
+		bool simplify = true;
+		unsigned char corners = 0;
+		unsigned char unset_corners = 0;
+		unsigned char mid_sign = 0;
+		quadric3 node_pq;
+		FVector3f avg_normal = FVector3f(0.f);
+		uint8 count = 0;
+
+		for (uint8 i = 0; i < 8; i++)
+		{
+			if (!node.ChildExists(i))
+			{
+				unset_corners |= 1 << i;
+				continue;
+			}
+
+			const OctreeNode_smol& child = tree.nodes[node.GetChildIndex_Unchecked(i)];
+
+			mid_sign = (child.corners >> (7 - i)) & 1;
+			if (!simplify) continue;
+
+			if (child.type == NODE_INTERNAL)
+			{
+				//one of this child node's children stays a non-leaf, cant simplify this one.
+				simplify = false;
+			}
+			else
+			{
+				node_pq += tree.qefs[child.leaf_data_idx];
+				avg_normal += tree.normals[child.leaf_data_idx];
+				corners |= (((child.corners >> i) & 1) << i);
+				++count;
+			}
+		}
+
+		if (!simplify || !count) continue;
+
+		for (uint8 i = 0; i < 8; i++)
+		{
+			if ((unset_corners >> i) & 1) corners |= mid_sign << i;
+		}
+
+		FVector3f minimizer = node_pq.minimizer();
+		float error = node_pq(minimizer);
+
+		//possible simplification doesn't approximate the surface well
+		if (error > simplify_threshold) continue;
+
+		node.type = NODE_COLLAPSED_LEAF;
+		node.corners = corners;
+		node.leaf_data_idx = tree.minimizers.Num();
+
+		tree.minimizers.Add(minimizer);
+		tree.normals.Add(avg_normal / static_cast<float>(count));
+		tree.qefs.Add(node_pq);
+
+		collapsed_any = true;
+	}
+
+	if (collapsed_any) CompactOctree(tree);
+}
+
+void UOctreeCode::SimplifyOctreeBatched(OctreeNode* root, float simplify_threshold, OctreeNodeArena* arena)
+{
+#if USE_NAMED_STATS
+	QUICK_SCOPE_CYCLE_COUNTER(Stat_SimplifyOctreeBatched)
+#endif
+
+	if (!root || root->type) return;
+
+	//internal nodes per depth. a level only depends on the collapses of the level below it
+	TArray<TArray<OctreeNode*>> levels;
+	TArray<OctreeNode*> stack;
+	stack.Add(root);
+
+	while (!stack.IsEmpty())
+	{
+		OctreeNode* node = stack.Pop(EAllowShrinking::No);
+		if (node->type) continue;
+
+		if (levels.Num() <= node->depth) levels.SetNum(node->depth + 1);
+		levels[node->depth].Add(node);
+
+		for (uint8 i = 0; i < 8; i++)
+		{
+			if (node->children[i]) stack.Add(node->children[i]);
+		}
+	}
+
+	TArray<OctreeNode*> candidates;
+	TArray<uint8> candidate_corners;
+	TArray<FVector3f> candidate_normals;
+	TArray<const quadric3*> sources;
+	TArray<FVector3f> minimizers;
+	TArray<float> errors;
+	QuadricBatch qefs;
+
+	for (int32 depth = levels.Num() - 1; depth >= 0; depth--)
+	{
+		candidates.Reset();
+		candidate_corners.Reset();
+		candidate_normals.Reset();
+		sources.Reset();
+
+		for (OctreeNode* node : levels[depth])
+		{
+			bool simplify = true;
+			unsigned char corners = 0;
+			unsigned char unset_corners = 0;
+			unsigned char mid_sign = 0;
+			FVector3f avg_normal = node->leaf_data.normal;
+			uint8 count = 0;
+			const quadric3* node_sources[8] = { nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr };
+
+			for (uint8 i = 0; i < 8; i++)
+			{
+				const OctreeNode* child = node->children[i];
+				if (!child)
+				{
+					unset_corners |= 1 << i;
+					continue;
+				}
+
+				mid_sign = (child->corners >> (7 - i)) & 1;
+				if (!simplify) continue;
+
+				if (child->type == NODE_INTERNAL)
+				{
+					simplify = false;
+				}
+				else
+				{
+					node_sources[i] = &child->leaf_data.qef;
+					avg_normal += child->leaf_data.normal;
+					corners |= (((child->corners >> i) & 1) << i);
+					++count;
+				}
+			}
+
+			if (!simplify || !count) continue;
+
+			for (uint8 i = 0; i < 8; i++)
+			{
+				if ((unset_corners >> i) & 1) corners |= mid_sign << i;
+			}
+
+			candidates.Add(node);
+			candidate_corners.Add(corners);
+			candidate_normals.Add(avg_normal / static_cast<float>(count));
+			sources.Append(node_sources, 8);
+		}
+
+		if (candidates.IsEmpty()) continue;
+
+		minimizers.SetNumUninitialized(candidates.Num(), EAllowShrinking::No);
+		errors.SetNumUninitialized(candidates.Num(), EAllowShrinking::No);
+
+		qefs.Init(candidates.Num());
+		qefs.AccumulateQuadrics(sources.GetData(), 8);
+		qefs.Solve(minimizers.GetData(), errors.GetData());
+
+		for (int32 c = 0; c < candidates.Num(); c++)
+		{
+			//possible simplification doesn't approximate the surface well
+			if (errors[c] > simplify_threshold) continue;
+
+			OctreeNode* node = candidates[c];
+			node->type = NODE_COLLAPSED_LEAF;
+			node->corners = candidate_corners[c];
+			node->leaf_data.minimizer = minimizers[c];
+			node->leaf_data.normal = candidate_normals[c];
+			node->leaf_data.qef = qefs.Get(c);
+
+			for (uint8 i = 0; i < 8; i++)
+			{
+				if (arena && node->children[i]) arena->Free(node->children[i]);
+				node->children[i] = nullptr;
+			}
+		}
+	}
+}
+
+void UOctreeCode::SimplifyOctreeBatched(LinearOctree& tree, float simplify_threshold)
+{
+#if USE_NAMED_STATS
+	QUICK_SCOPE_CYCLE_COUNTER(Stat_SimplifyLinearOctreeBatched)
+#endif
+
+	bool collapsed_any = false;
+
+	TArray<uint32> candidates;
+	TArray<uint8> candidate_corners;
+	TArray<FVector3f> candidate_normals;
+	TArray<const quadric3*> sources;
+	TArray<FVector3f> minimizers;
+	TArray<float> errors;
+	QuadricBatch qefs;
+
+	//breadth first storage keeps every depth contiguous, walk the levels from the back
+	int32 level_end = tree.nodes.Num();
+	while (level_end > 0)
+	{
+		const uint8 depth = tree.nodes[level_end - 1].depth;
+		int32 level_begin = level_end - 1;
+		while (level_begin > 0 && tree.nodes[level_begin - 1].depth == depth) level_begin--;
+
+		candidates.Reset();
+		candidate_corners.Reset();
+		candidate_normals.Reset();
+		sources.Reset();
+
+		for (int32 node_idx = level_begin; node_idx < level_end; node_idx++)
+		{
+			const OctreeNode_smol& node = tree.nodes[node_idx];
+			if (node.type) continue;
+
+			bool simplify = true;
+			unsigned char corners = 0;
+			unsigned char unset_corners = 0;
+			unsigned char mid_sign = 0;
+			FVector3f avg_normal = FVector3f(0.f);
+			uint8 count = 0;
+			const quadric3* node_sources[8] = { nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr };
+
+			for (uint8 i = 0; i < 8; i++)
+			{
+				if (!node.ChildExists(i))
+				{
+					unset_corners |= 1 << i;
+					continue;
+				}
+
+				const OctreeNode_smol& child = tree.nodes[node.GetChildIndex_Unchecked(i)];
+
+				mid_sign = (child.corners >> (7 - i)) & 1;
+				if (!simplify) continue;
+
+				if (child.type == NODE_INTERNAL)
+				{
+					simplify = false;
+				}
+				else
+				{
+					node_sources[i] = &tree.qefs[child.leaf_data_idx];
+					avg_normal += tree.normals[child.leaf_data_idx];
+					corners |= (((child.corners >> i) & 1) << i);
+					++count;
+				}
+			}
+
+			if (!simplify || !count) continue;
+
+			for (uint8 i = 0; i < 8; i++)
+			{
+				if ((unset_corners >> i) & 1) corners |= mid_sign << i;
+			}
+
+			candidates.Add(node_idx);
+			candidate_corners.Add(corners);
+			candidate_normals.Add(avg_normal / static_cast<float>(count));
+			sources.Append(node_sources, 8);
+		}
+
+		level_end = level_begin;
+
+		if (candidates.IsEmpty()) continue;
+
+		minimizers.SetNumUninitialized(candidates.Num(), EAllowShrinking::No);
+		errors.SetNumUninitialized(candidates.Num(), EAllowShrinking::No);
+
+		//sources point into tree.qefs, solve before anything gets appended to it
+		qefs.Init(candidates.Num());
+		qefs.AccumulateQuadrics(sources.GetData(), 8);
+		qefs.Solve(minimizers.GetData(), errors.GetData());
+
+		for (int32 c = 0; c < candidates.Num(); c++)
+		{
+			//possible simplification doesn't approximate the surface well
+			if (errors[c] > simplify_threshold) continue;
+
+			OctreeNode_smol& node = tree.nodes[candidates[c]];
+			node.type = NODE_COLLAPSED_LEAF;
+			node.corners = candidate_corners[c];
+			node.leaf_data_idx = tree.minimizers.Num();
+
+			tree.minimizers.Add(minimizers[c]);
+			tree.normals.Add(candidate_normals[c]);
+			tree.qefs.Add(qefs.Get(c));
+
+			collapsed_any = true;
+		}
+	}
+
+	if (collapsed_any) CompactOctree(tree);
+}
+
+void UOctreeCode::LinearizeOctree(const OctreeNode* root, LinearOctree& tree)
+{
+	tree.Reset();
+
+	if (!root) return;
+
+	//pointer node of every linear node, doubles as the breadth first queue
+	TArray<const OctreeNode*> sources;
+	sources.Add(root);
+
+	for (int32 i = 0; i < sources.Num(); i++)
+	{
+		const OctreeNode* node = sources[i];
+
+		OctreeNode_smol linear_node;
+		linear_node.depth = node->depth;
+		linear_node.type = node->type;
+		linear_node.corners = node->corners;
+
+		if (node->type == NODE_INTERNAL)
+		{
+			linear_node.first_child = sources.Num();
+
+			for (uint8 child = 0; child < 8; child++)
+			{
+				if (!node->children[child]) continue;
+
+				linear_node.child_mask |= 1 << child;
+				sources.Add(node->children[child]);
+			}
+		}
+		else
+		{
+			linear_node.leaf_data_idx = tree.minimizers.Num();
+
+			tree.minimizers.Add(node->leaf_data.minimizer);
+			tree.normals.Add(node->leaf_data.normal);
+			tree.qefs.Add(node->leaf_data.qef);
+		}
+
+		tree.nodes.Add(linear_node);
+	}
+}
+
+void UOctreeCode::CompactOctree(LinearOctree& tree)
+{
+	LinearOctree compacted;
+	compacted.nodes.Reserve(tree.nodes.Num());
+	compacted.minimizers.Reserve(tree.minimizers.Num());
+	compacted.normals.Reserve(tree.normals.Num());
+	compacted.qefs.Reserve(tree.qefs.Num());
+
+	//old index of every compacted node, doubles as the breadth first queue
+	TArray<uint32> sources;
+	sources.Add(0);
+
+	for (int32 i = 0; i < sources.Num(); i++)
+	{
+		const OctreeNode_smol& old_node = tree.nodes[sources[i]];
+		OctreeNode_smol node = old_node;
+
+		if (node.type == NODE_INTERNAL)
+		{
+			node.first_child = sources.Num();
+
+			for (uint8 child = 0; child < 8; child++)
+			{
+				if (old_node.ChildExists(child)) sources.Add(old_node.GetChildIndex_Unchecked(child));
+			}
+		}
+		else
+		{
+			//collapsed leaves lose their subtree here
+			node.first_child = INDEX_NOEXIST;
+			node.child_mask = 0;
+			node.leaf_data_idx = compacted.minimizers.Num();
+
+			compacted.minimizers.Add(tree.minimizers[old_node.leaf_data_idx]);
+			compacted.normals.Add(tree.normals[old_node.leaf_data_idx]);
+			compacted.qefs.Add(tree.qefs[old_node.leaf_data_idx]);
+		}
+
+		compacted.nodes.Add(node);
+	}
+
+	tree = MoveTemp(compacted);
+}
+
+void UOctreeCode::FinalizeProgressiveOctree(ProgressiveOctree& progressive, bool batched_qef)
+{
+#if USE_NAMED_STATS
+	QUICK_SCOPE_CYCLE_COUNTER(Stat_FinalizeProgressiveOctree)
+#endif
+
+	LinearOctree& tree = progressive.tree;
+
+	progressive.collapse_errors.SetNumZeroed(tree.minimizers.Num());
+	progressive.collapse_corners.SetNumUninitialized(tree.minimizers.Num());
+	for (const OctreeNode_smol& node : tree.nodes)
+	{
+		if (node.type) progressive.collapse_corners[node.leaf_data_idx] = node.corners;
+	}
+
+	TArray<uint32> candidates;
+	TArray<uint8> candidate_corners;
+	TArray<FVector3f> candidate_normals;
+	TArray<float> candidate_child_errors;
+	TArray<const quadric3*> sources;
+	TArray<FVector3f> minimizers;
+	TArray<float> errors;
+	TArray<quadric3> scalar_qefs;
+	QuadricBatch qefs;
+
+	//walked like SimplifyOctreeBatched, except every internal node is a candidate: its children all carry leaf data by the time its level comes up
+	int32 level_end = tree.nodes.Num();
+	while (level_end > 0)
+	{
+		const uint8 depth = tree.nodes[level_end - 1].depth;
+		int32 level_begin = level_end - 1;
+		while (level_begin > 0 && tree.nodes[level_begin - 1].depth == depth) level_begin--;
+
+		candidates.Reset();
+		candidate_corners.Reset();
+		candidate_normals.Reset();
+		candidate_child_errors.Reset();
+		sources.Reset();
+
+		for (int32 node_idx = level_begin; node_idx < level_end; node_idx++)
+		{
+			const OctreeNode_smol& node = tree.nodes[node_idx];
+			if (node.type) continue;
+
+			unsigned char corners = 0;
+			unsigned char unset_corners = 0;
+			unsigned char mid_sign = 0;
+			FVector3f avg_normal = FVector3f(0.f);
+			float child_error = 0.f;
+			uint8 count = 0;
+			const quadric3* node_sources[8] = { nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr };
+
+			for (uint8 i = 0; i < 8; i++)
+			{
+				if (!node.ChildExists(i))
+				{
+					unset_corners |= 1 << i;
+					continue;
+				}
+
+				const OctreeNode_smol& child = tree.nodes[node.GetChildIndex_Unchecked(i)];
+				const uint8 child_corners = progressive.collapse_corners[child.leaf_data_idx];
+
+				mid_sign = (child_corners >> (7 - i)) & 1;
+
+				node_sources[i] = &tree.qefs[child.leaf_data_idx];
+				avg_normal += tree.normals[child.leaf_data_idx];
+				corners |= (((child_corners >> i) & 1) << i);
+				child_error = FMath::Max(child_error, progressive.collapse_errors[child.leaf_data_idx]);
+				++count;
+			}
+
+			for (uint8 i = 0; i < 8; i++)
+			{
+				if ((unset_corners >> i) & 1) corners |= mid_sign << i;
+			}
+
+			candidates.Add(node_idx);
+			candidate_corners.Add(corners);
+			candidate_normals.Add(avg_normal / static_cast<float>(count));
+			candidate_child_errors.Add(child_error);
+			sources.Append(node_sources, 8);
+		}
+
+		level_end = level_begin;
+
+		if (candidates.IsEmpty()) continue;
+
+		minimizers.SetNumUninitialized(candidates.Num(), EAllowShrinking::No);
+		errors.SetNumUninitialized(candidates.Num(), EAllowShrinking::No);
+
+		//sources point into tree.qefs, solve before anything gets appended to it
+		if (batched_qef)
+		{
+			qefs.Init(candidates.Num());
+			qefs.AccumulateQuadrics(sources.GetData(), 8);
+			qefs.Solve(minimizers.GetData(), errors.GetData());
+		}
+		else
+		{
+			scalar_qefs.SetNum(candidates.Num(), EAllowShrinking::No);
+			for (int32 c = 0; c < candidates.Num(); c++)
+			{
+				scalar_qefs[c] = quadric3();
+				for (int32 i = 0; i < 8; i++)
+				{
+					if (sources[c * 8 + i]) scalar_qefs[c] += *sources[c * 8 + i];
+				}
+
+				minimizers[c] = scalar_qefs[c].minimizer();
+				errors[c] = scalar_qefs[c](minimizers[c]);
+			}
+		}
+
+		for (int32 c = 0; c < candidates.Num(); c++)
+		{
+			OctreeNode_smol& node = tree.nodes[candidates[c]];
+			node.leaf_data_idx = tree.minimizers.Num();
 
-	return true;
+			tree.minimizers.Add(minimizers[c]);
+			tree.normals.Add(candidate_normals[c]);
+			tree.qefs.Add(batched_qef ? qefs.Get(c) : scalar_qefs[c]);
+
+			//a node only collapses once every internal node below it did
+			progressive.collapse_errors.Add(FMath::Max(errors[c], candidate_child_errors[c]));
+			progressive.collapse_corners.Add(candidate_corners[c]);
+		}
+	}
 }
 
 void UOctreeCode::BuildMeshData(OctreeNode* node, MeshBuilder& builder)
@@ -684,7 +2101,7 @@ void UOctreeCode::BuildMeshData(OctreeNode* node, MeshBuilder& builder)
 	{
 		for (uint8 i = 0; i < 8; i++)
 		{
-			BuildMeshData(node->children[i].Get(), builder);
+			BuildMeshData(node->children[i], builder);
 		}
 	}
 	else 
@@ -694,6 +2111,28 @@ void UOctreeCode::BuildMeshData(OctreeNode* node, MeshBuilder& builder)
 	}
 }
 
+void UOctreeCode::BuildMeshData(const LinearOctree& tree, MeshBuilder& builder)
+{
+	//DC_ProcessEdge uses leaf_data_idx as vertex index, the main tree has to go in first
+	checkSlow(builder.NumVertices() == 0);
+
+	for (int32 i = 0; i < tree.minimizers.Num(); i++)
+	{
+		builder.AddVertex(tree.minimizers[i] * inv_scale_factor).SetNormal(tree.normals[i]);
+	}
+}
+
+void UOctreeCode::BuildMeshData(const UniformLeafGrid& grid, MeshBuilder& builder)
+{
+	//DC_ProcessGrid uses the voxel rank as vertex index
+	checkSlow(builder.NumVertices() == 0);
+
+	for (int32 i = 0; i < grid.minimizers.Num(); i++)
+	{
+		builder.AddVertex(grid.minimizers[i] * inv_scale_factor).SetNormal(grid.normals[i]);
+	}
+}
+
 void UOctreeCode::BuildStitchMeshData(OctreeNode* node, OctreeNode* parent, MeshBuilder& builder)
 {
 	// left x side
@@ -706,7 +2145,7 @@ void UOctreeCode::BuildStitchMeshData(OctreeNode* node, OctreeNode* parent, Mesh
 		{
 			for (uint8 i = 0; i < 4; i++)
 			{
-				self(self, node->children[i].Get(), builder);
+				self(self, node->children[i], builder);
 			}
 		}
 		else 
@@ -755,24 +2194,24 @@ void UOctreeCode::DC_ProcessCell(OctreeNode* node, MeshBuilder& builder)
 		// recurse to each child 
 		for (size_t i = 0; i < 8; i++)
 		{
-			DC_ProcessCell(node->children[i].Get(), builder);
+			DC_ProcessCell(node->children[i], builder);
 		}
 
 		//handles every interior face of the node
 		for (size_t i = 0; i < 12; i++)
 		{
-			OctreeNode* child_1 = node->children[process_cell_face_nodes[i][0]].Get();
-			OctreeNode* child_2 = node->children[process_cell_face_nodes[i][1]].Get();
+			OctreeNode* child_1 = node->children[process_cell_face_nodes[i][0]];
+			OctreeNode* child_2 = node->children[process_cell_face_nodes[i][1]];
 			DC_ProcessFace(child_1, child_2, process_cell_face_nodes[i][2], builder);
 		}
 
 		//interior 6 edges of this node
 		for (size_t i = 0; i < 6; i++)
 		{
-			OctreeNode* child_1 = node->children[process_edge_nodes[i][0]].Get();
-			OctreeNode* child_2 = node->children[process_edge_nodes[i][1]].Get();
-			OctreeNode* child_3 = node->children[process_edge_nodes[i][2]].Get();
-			OctreeNode* child_4 = node->children[process_edge_nodes[i][3]].Get();
+			OctreeNode* child_1 = node->children[process_edge_nodes[i][0]];
+			OctreeNode* child_2 = node->children[process_edge_nodes[i][1]];
+			OctreeNode* child_3 = node->children[process_edge_nodes[i][2]];
+			OctreeNode* child_4 = node->children[process_edge_nodes[i][3]];
 			DC_ProcessEdge(child_1, child_2, child_3, child_4, process_edge_nodes[i][4], builder);
 		}
 	}
@@ -820,7 +2259,7 @@ void UOctreeCode::DC_ProcessFace(OctreeNode* node_1, OctreeNode* node_2, unsigne
 			OctreeNode* face_node_1 = nullptr;
 			if(node_1->type == NODE_INTERNAL)
 			{
-				face_node_1 = node_1->children[process_face_direction_cells[direction][face_idx][0]].Get();
+				face_node_1 = node_1->children[process_face_direction_cells[direction][face_idx][0]];
 			}
 			else //node is a leaf / collapsed leaf 
 			{
@@ -830,7 +2269,7 @@ void UOctreeCode::DC_ProcessFace(OctreeNode* node_1, OctreeNode* node_2, unsigne
 			OctreeNode* face_node_2 = nullptr;
 			if(node_2->type == NODE_INTERNAL)
 			{
-				face_node_2 = node_2->children[process_face_direction_cells[direction][face_idx][1]].Get();
+				face_node_2 = node_2->children[process_face_direction_cells[direction][face_idx][1]];
 			}
 			else face_node_2 = node_2;
 
@@ -870,7 +2309,7 @@ void UOctreeCode::DC_ProcessFace(OctreeNode* node_1, OctreeNode* node_2, unsigne
 				}
 				else 
 				{
-					edge_nodes[node_idx] = face_nodes[order[node_idx]]->children[indices[node_idx]].Get();
+					edge_nodes[node_idx] = face_nodes[order[node_idx]]->children[indices[node_idx]];
 				}
 			}
 
@@ -1024,7 +2463,7 @@ void UOctreeCode::DC_ProcessEdge(OctreeNode* node_1, OctreeNode* node_2, OctreeN
 				}
 				else 
 				{
-					next_edge_nodes[node_idx] = edge_nodes[node_idx]->children[process_sub_edge_nodes[direction][i][node_idx]].Get();
+					next_edge_nodes[node_idx] = edge_nodes[node_idx]->children[process_sub_edge_nodes[direction][i][node_idx]];
 				}
 			}
 
@@ -1252,6 +2691,331 @@ void UOctreeCode::DC_ProcessEdge(StitchOctreeNode* node_1, StitchOctreeNode* nod
 	}
 }
 
+void UOctreeCode::DC_ProcessCell(const LinearOctree& tree, uint32 node_idx, MeshBuilder& builder)
+{
+	if (node_idx == INDEX_NOEXIST) return;
+
+	const OctreeNode_smol& node = tree.nodes[node_idx];
+
+	if (node.type == NODE_INTERNAL) // if node is internal
+	{
+		// recurse to each child 
+		for (uint8 i = 0; i < 8; i++)
+		{
+			DC_ProcessCell(tree, node.GetChildIndex(i), builder);
+		}
+
+		//handles every interior face of the node
+		for (size_t i = 0; i < 12; i++)
+		{
+			uint32 child_1 = node.GetChildIndex(process_cell_face_nodes[i][0]);
+			uint32 child_2 = node.GetChildIndex(process_cell_face_nodes[i][1]);
+			DC_ProcessFace(tree, child_1, child_2, process_cell_face_nodes[i][2], builder);
+		}
+
+		//interior 6 edges of this node
+		for (size_t i = 0; i < 6; i++)
+		{
+			uint32 child_1 = node.GetChildIndex(process_edge_nodes[i][0]);
+			uint32 child_2 = node.GetChildIndex(process_edge_nodes[i][1]);
+			uint32 child_3 = node.GetChildIndex(process_edge_nodes[i][2]);
+			uint32 child_4 = node.GetChildIndex(process_edge_nodes[i][3]);
+			DC_ProcessEdge(tree, child_1, child_2, child_3, child_4, process_edge_nodes[i][4], builder);
+		}
+	}
+}
+
+void UOctreeCode::DC_ProcessFace(const LinearOctree& tree, uint32 node_1, uint32 node_2, unsigned char direction, MeshBuilder& builder)
+{
+	if (node_1 == INDEX_NOEXIST || node_2 == INDEX_NOEXIST) return;
+
+	const OctreeNode_smol& linear_node_1 = tree.nodes[node_1];
+	const OctreeNode_smol& linear_node_2 = tree.nodes[node_2];
+
+	//either one of the nodes has children nodes
+	if (linear_node_1.type == NODE_INTERNAL || linear_node_2.type == NODE_INTERNAL)
+	{
+		// 4 face calls
+		for (size_t face_idx = 0; face_idx < 4; face_idx++)
+		{
+			uint32 face_node_1 = linear_node_1.type == NODE_INTERNAL ? linear_node_1.GetChildIndex(process_face_direction_cells[direction][face_idx][0]) : node_1;
+			uint32 face_node_2 = linear_node_2.type == NODE_INTERNAL ? linear_node_2.GetChildIndex(process_face_direction_cells[direction][face_idx][1]) : node_2;
+
+			DC_ProcessFace(tree, face_node_1, face_node_2, direction, builder);
+		}
+
+		const unsigned char orders[2][4] =
+		{
+			{ 0, 0, 1, 1 },
+			{ 0, 1, 0, 1 },
+		};
+
+		const uint32 face_nodes[2] = { node_1, node_2 };
+
+		// 4 edge calls, on the boundary between nodes
+		for (size_t edge_idx = 0; edge_idx < 4; edge_idx++)
+		{
+			uint32 edge_nodes[4];
+
+			unsigned char indices[4] =
+			{
+				process_face_edge_nodes[direction][edge_idx][1],
+				process_face_edge_nodes[direction][edge_idx][2],
+				process_face_edge_nodes[direction][edge_idx][3],
+				process_face_edge_nodes[direction][edge_idx][4]
+			};
+
+			const unsigned char* order = orders[process_face_edge_nodes[direction][edge_idx][0]];
+			for (size_t node_idx = 0; node_idx < 4; node_idx++)
+			{
+				const OctreeNode_smol& face_node = tree.nodes[face_nodes[order[node_idx]]];
+
+				if (face_node.type != NODE_INTERNAL)
+				{
+					edge_nodes[node_idx] = face_nodes[order[node_idx]];
+				}
+				else
+				{
+					edge_nodes[node_idx] = face_node.GetChildIndex(indices[node_idx]);
+				}
+			}
+
+			DC_ProcessEdge(tree, edge_nodes[0], edge_nodes[1], edge_nodes[2], edge_nodes[3], process_face_edge_nodes[direction][edge_idx][5], builder);
+		}
+	}
+}
+
+void UOctreeCode::DC_ProcessEdge(const LinearOctree& tree, uint32 node_1, uint32 node_2, uint32 node_3, uint32 node_4, unsigned char direction, MeshBuilder& builder)
+{
+	if (node_1 == INDEX_NOEXIST || node_2 == INDEX_NOEXIST || node_3 == INDEX_NOEXIST || node_4 == INDEX_NOEXIST) return;
+
+	const uint32 edge_node_indices[4] = { node_1, node_2, node_3, node_4 };
+	const OctreeNode_smol* edge_nodes[4] = { &tree.nodes[node_1], &tree.nodes[node_2], &tree.nodes[node_3], &tree.nodes[node_4] };
+
+	if (edge_nodes[0]->type && edge_nodes[1]->type && edge_nodes[2]->type && edge_nodes[3]->type)
+	{
+		//all nodes are leaves / collapsed, we can add to the polygon buffer
+
+		uint32 indices[4];
+		unsigned char sign_changes[4] = { 0, 0, 0, 0 };
+
+		// we only want to add quads for a smallest node that owns the edge
+		unsigned char lowest_depth = 0;
+		// used to idx into sign_changes
+		unsigned char minimal_node_idx = 0;
+
+		bool flip = false;
+
+		for (size_t node_idx = 0; node_idx < 4; node_idx++)
+		{
+			unsigned char edge_idx = node_edge[direction][node_idx];
+
+			unsigned char corner_1 = edge_corners[edge_idx][0];
+			unsigned char corner_2 = edge_corners[edge_idx][1];
+
+			unsigned char inside_1 = (edge_nodes[node_idx]->corners >> corner_1) & 1;
+			unsigned char inside_2 = (edge_nodes[node_idx]->corners >> corner_2) & 1;
+
+			//see BuildMeshData, leaf data index is the vertex index
+			indices[node_idx] = edge_nodes[node_idx]->leaf_data_idx;
+
+			sign_changes[node_idx] = inside_1 != inside_2;
+
+			if (edge_nodes[node_idx]->depth > lowest_depth)
+			{
+				lowest_depth = edge_nodes[node_idx]->depth;
+				minimal_node_idx = node_idx;
+				flip = static_cast<bool>(inside_1);
+			}
+		}
+
+		if (sign_changes[minimal_node_idx])
+		{
+			if (flip)
+			{
+				builder.AddTriangle(indices[0], indices[1], indices[3]);
+				builder.AddTriangle(indices[0], indices[3], indices[2]);
+			}
+			else
+			{
+				builder.AddTriangle(indices[0], indices[3], indices[1]);
+				builder.AddTriangle(indices[0], indices[2], indices[3]);
+			}
+		}
+	}
+	else
+	{
+		for (size_t i = 0; i < 2; i++)
+		{
+			uint32 next_edge_nodes[4];
+			for (size_t node_idx = 0; node_idx < 4; node_idx++)
+			{
+				if (edge_nodes[node_idx]->type)
+				{
+					//leaf
+					next_edge_nodes[node_idx] = edge_node_indices[node_idx];
+				}
+				else
+				{
+					next_edge_nodes[node_idx] = edge_nodes[node_idx]->GetChildIndex(process_sub_edge_nodes[direction][i][node_idx]);
+				}
+			}
+
+			DC_ProcessEdge(tree, next_edge_nodes[0], next_edge_nodes[1], next_edge_nodes[2], next_edge_nodes[3], process_sub_edge_nodes[direction][i][4], builder);
+		}
+	}
+}
+
+// per edge axis (x, y, z): the other 3 voxels of the quad relative to the owner voxel, in DC_ProcessEdge node order
+constexpr int32 uniform_quad_offsets[3][3][3] =
+{
+	{{0,0,1},{0,1,0},{0,1,1}},
+	{{1,0,0},{0,0,1},{1,0,1}},
+	{{0,1,0},{1,0,0},{1,1,0}}
+};
+
+// corner of the owner voxel at the low end of its edge along each axis, the high end is always corner 7
+constexpr uint8 uniform_edge_low_corner[3] = { 6, 3, 5 };
+
+// find_vertex(voxel, corners*) returns the vertex of voxel or INDEX_NOEXIST, corners is only asked for on the owner.
+// all uniform leaves share one depth, so the winding is the one DC_ProcessEdge takes from its first node
+template<typename FindVertexType>
+static FORCEINLINE void EmitUniformEdgeQuad(const FIntVector3& owner, int32 axis, FindVertexType&& find_vertex, MeshBuilder& builder)
+{
+	uint8 corners = 0;
+	uint32 indices[4];
+
+	indices[0] = find_vertex(owner, &corners);
+	if (indices[0] == INDEX_NOEXIST) return;
+
+	const uint8 low_corner = uniform_edge_low_corner[axis];
+	if (!(((corners >> low_corner) ^ (corners >> 7)) & 1)) return;
+
+	for (int32 i = 0; i < 3; i++)
+	{
+		const int32* offset = uniform_quad_offsets[axis][i];
+
+		indices[i + 1] = find_vertex(owner + FIntVector3(offset[0], offset[1], offset[2]), nullptr);
+		if (indices[i + 1] == INDEX_NOEXIST) return;
+	}
+
+	if ((corners >> low_corner) & 1)
+	{
+		builder.AddTriangle(indices[0], indices[1], indices[3]);
+		builder.AddTriangle(indices[0], indices[3], indices[2]);
+	}
+	else
+	{
+		builder.AddTriangle(indices[0], indices[3], indices[1]);
+		builder.AddTriangle(indices[0], indices[2], indices[3]);
+	}
+}
+
+void UOctreeCode::DC_ProcessGrid(const UniformLeafGrid& grid, MeshBuilder& builder)
+{
+#if USE_NAMED_STATS
+	QUICK_SCOPE_CYCLE_COUNTER(Stat_DC_ProcessGrid)
+#endif
+
+	const int32 dim = grid.dim;
+
+	//edges on the chunk boundary reach outside of grid and are left to the seam
+	auto find_vertex = [&grid, dim](const FIntVector3& p, uint8* out_corners) -> uint32
+		{
+			if (p.X >= dim || p.Y >= dim || p.Z >= dim) return INDEX_NOEXIST;
+
+			const uint32 vertex = grid.FindVertex(Get1DIndexFrom3D(p.X, p.Y, p.Z, dim));
+			if (out_corners && vertex != INDEX_NOEXIST) *out_corners = grid.corners[vertex];
+
+			return vertex;
+		};
+
+	//only active voxels can own an edge with a sign change, walk their bits in voxel order
+	for (int32 w = 0; w < grid.active_words.Num(); w++)
+	{
+		uint64 word = grid.active_words[w];
+		while (word)
+		{
+			const int32 voxel = (w << 6) + static_cast<int32>(FMath::CountTrailingZeros64(word));
+			word &= word - 1;
+
+			const FIntVector3 owner = FIntVector3(voxel / (dim * dim), (voxel / dim) % dim, voxel % dim);
+
+			for (int32 axis = 0; axis < 3; axis++)
+			{
+				EmitUniformEdgeQuad(owner, axis, find_vertex, builder);
+			}
+		}
+	}
+}
+
+void UOctreeCode::DC_ProcessGridSeam(const TArray<const UniformLeafGrid*, TInlineAllocator<8>>& grids, bool negative_delta, MeshBuilder& builder)
+{
+#if USE_NAMED_STATS
+	QUICK_SCOPE_CYCLE_COUNTER(Stat_DC_ProcessGridSeam)
+#endif
+
+	const int32 dim = grids[main_node[negative_delta]]->dim;
+
+	//the seam is its own section group, vertices of every chunk are only added once a seam quad uses them
+	TMap<uint64, uint32> seam_vertices;
+
+	//p is in voxels of the 2x2x2 chunk block, octant i sits at (x = bit 0, y = bit 2, z = bit 1)
+	auto find_vertex = [&grids, &seam_vertices, &builder, dim](const FIntVector3& p, uint8* out_corners) -> uint32
+		{
+			const FIntVector3 chunk_offset = FIntVector3(p.X >= dim, p.Y >= dim, p.Z >= dim);
+			const uint8 octant = static_cast<uint8>(chunk_offset.X | (chunk_offset.Z << 1) | (chunk_offset.Y << 2));
+
+			const UniformLeafGrid* grid = grids[octant];
+			if (!grid || grid->IsEmpty()) return INDEX_NOEXIST;
+
+			checkSlow(grid->dim == dim);
+
+			const FIntVector3 local = p - chunk_offset * dim;
+			const uint32 rank = grid->FindVertex(Get1DIndexFrom3D(local.X, local.Y, local.Z, dim));
+			if (rank == INDEX_NOEXIST) return INDEX_NOEXIST;
+
+			if (out_corners) *out_corners = grid->corners[rank];
+
+			uint32& vertex = seam_vertices.FindOrAdd((static_cast<uint64>(octant) << 32) | rank, INDEX_NOEXIST);
+			if (vertex == INDEX_NOEXIST)
+			{
+				vertex = builder.AddVertex(grid->minimizers[rank] * inv_scale_factor).SetNormal(grid->normals[rank]).GetIndex();
+			}
+
+			return vertex;
+		};
+
+	//negative_delta: edges owned by the main chunk that reach into its positive neighbours.
+	//otherwise: edges reaching into the main chunk (at octant 7) from the owners in its negative neighbours
+	const int32 along_min = negative_delta ? 0 : dim;
+	const int32 other_min = negative_delta ? 0 : dim - 1;
+
+	for (int32 axis = 0; axis < 3; axis++)
+	{
+		const int32 axis_b = (axis + 1) % 3;
+		const int32 axis_c = (axis + 2) % 3;
+
+		for (int32 b = other_min; b < other_min + dim; b++)
+		{
+			for (int32 c = other_min; c < other_min + dim; c++)
+			{
+				//the 4 voxels of the edge stay inside one chunk
+				if (b != dim - 1 && c != dim - 1) continue;
+
+				for (int32 a = along_min; a < along_min + dim; a++)
+				{
+					FIntVector3 owner;
+					owner[axis] = a;
+					owner[axis_b] = b;
+					owner[axis_c] = c;
+
+					EmitUniformEdgeQuad(owner, axis, find_vertex, builder);
+				}
+			}
+		}
+	}
+}
 
 void UOctreeCode::DebugDrawOctree(UWorld* world, OctreeNode* node, int32 current_depth, bool draw_leaves, bool draw_simple_leaves, int32 how_deep)
 {
@@ -1274,7 +3038,7 @@ void UOctreeCode::DebugDrawOctree(UWorld* world, OctreeNode* node, int32 current
 	{
 		if(node->children[i])
 		{
-			DebugDrawOctree(world, node->children[i].Get(), current_depth+1, draw_leaves, draw_simple_leaves, how_deep);
+			DebugDrawOctree(world, node->children[i], current_depth+1, draw_leaves, draw_simple_leaves, how_deep);
 		}
 	}
 }
@@ -1301,7 +3065,7 @@ void UOctreeCode::DebugDrawNodeMinimizer(OctreeNode* node)
 
 	for (size_t i = 0; i < 8; i++)
 	{
-		DebugDrawNodeMinimizer(node->children[i].Get());	
+		DebugDrawNodeMinimizer(node->children[i]);	
 	}
 
 	if(node->type)
@@ -1317,39 +3081,67 @@ void UOctreeCode::DebugDrawNodeMinimizer(OctreeNode* node)
 	
 }
 
-FVector3f UOctreeCode::FDMGetNormal(const FVector3f& at_point, float h, int32 seed)
+bool UOctreeCode::GetSDFOpsGradient(const FVector3f& p, float noise_density, float iso_surface, float eps, const TArray<FSDFOp>& sdf_ops, FVector3f& out_gradient)
 {
-	//x, y, z axii order
-	const float x_positions[6] = { at_point.X + h,  at_point.X - h, at_point.X, at_point.X, at_point.X, at_point.X };
-	const float y_positions[6] = { at_point.Y,  at_point.Y, at_point.Y + h, at_point.Y - h, at_point.Y, at_point.Y };
-	const float z_positions[6] = { at_point.Z,  at_point.Z, at_point.Z, at_point.Z, at_point.Z + h, at_point.Z - h };
+	//evaluate the csg chain the same way ApplySDFOps does, remembering which term each min / max leaves on top
+	float density = noise_density;
+	FVector3f winner_gradient = FVector3f(0.f);
+	bool op_wins = false;
+
+	for (int32 sdf_idx = 0; sdf_idx < sdf_ops.Num(); sdf_idx++)
+	{
+		const FSDFOp& sdf_op = sdf_ops[sdf_idx];
 
-	TArray<float> noise = UNoiseDataGenerator::GetNoiseFromPositions3D_NonThreaded(x_positions, y_positions, z_positions, 6, seed);
+		FVector3f local_pos = p - (sdf_op.position*0.01f);
 
-	FVector3f normal = FVector3f(noise[0] - noise[1], noise[2] - noise[3], noise[4] - noise[5]);
+		float sdf_val = 0.f;
+		FVector3f gradient = FVector3f(0.f);
+		switch (sdf_op.sdf_type)
+		{
+		case SDFType::Box:
+			sdf_val = SDF::Box(local_pos, ((sdf_op.bounds_size * 0.5f) * 0.01f));
+			gradient = SDF::BoxGradient(local_pos, ((sdf_op.bounds_size * 0.5f) * 0.01f));
+			break;
+		case SDFType::Sphere:
+			sdf_val = SDF::Sphere(local_pos, (sdf_op.bounds_size.X * 0.5f) * 0.01f);
+			gradient = SDF::SphereGradient(local_pos, (sdf_op.bounds_size.X * 0.5f) * 0.01f);
+			break;
+		}
 
-	normal /= (2.f * h);
+		//subtract is max(f, -sdf), union min(f, sdf)
+		bool wins = false;
+		switch (sdf_op.mod_type)
+		{
+		case ModType::Subtract:
+			sdf_val = -sdf_val;
+			gradient = -gradient;
+			wins = sdf_val > density;
+			break;
+		case ModType::Union:
+			wins = sdf_val < density;
+			break;
+		}
 
-#if UE_BUILD_DEBUG
-	if(normal.X == 0.f && normal.Y == 0.f && normal.Z == 0.f) 
-	{
-		//check(false);
+		if (wins)
+		{
+			density = sdf_val;
+			winner_gradient = gradient;
+			op_wins = true;
+		}
 	}
-#endif
 
-	return normal.GetUnsafeNormal();
+	//the noise produces the surface here, or the chain doesn't cross the iso surface at the interpolated point
+	if (!op_wins || FMath::Abs(density - iso_surface) > eps) return false;
+	//box diagonals and the sphere center have no single normal, fdm handles those
+	if (winner_gradient.IsNearlyZero()) return false;
+
+	out_gradient = winner_gradient;
+	return true;
 }
 
-FVector3f UOctreeCode::FDMGetNormal_SDF(const FVector3f& at_point, float h, int32 seed, const TArray<FSDFOp>& sdf_ops)
+void UOctreeCode::ApplySDFOps(float* noise, const float* x_positions, const float* y_positions, const float* z_positions, int32 count, const TArray<FSDFOp>& sdf_ops)
 {
-	//x, y, z axii order
-	const float x_positions[6] = { at_point.X + h,  at_point.X - h, at_point.X, at_point.X, at_point.X, at_point.X };
-	const float y_positions[6] = { at_point.Y,  at_point.Y, at_point.Y + h, at_point.Y - h, at_point.Y, at_point.Y };
-	const float z_positions[6] = { at_point.Z,  at_point.Z, at_point.Z, at_point.Z, at_point.Z + h, at_point.Z - h };
-
-	TArray<float> noise = UNoiseDataGenerator::GetNoiseFromPositions3D_NonThreaded(x_positions, y_positions, z_positions, 6, seed);
-
-	for (int32 i = 0; i < 6; i++)
+	for (int32 i = 0; i < count; i++)
 	{
 		FVector3f pos = FVector3f(x_positions[i], y_positions[i], z_positions[i]);
 
@@ -1381,22 +3173,9 @@ FVector3f UOctreeCode::FDMGetNormal_SDF(const FVector3f& at_point, float h, int3
 			}
 		}
 	}
-
-	FVector3f normal = FVector3f(noise[0] - noise[1], noise[2] - noise[3], noise[4] - noise[5]);
-
-	normal /= (2.f * h);
-
-#if UE_BUILD_DEBUG
-	if (normal.X == 0.f && normal.Y == 0.f && normal.Z == 0.f)
-	{
-		//check(false);
-	}
-#endif
-
-	return normal.GetUnsafeNormal();
 }
 
-TUniquePtr<OctreeNode>* UOctreeCode::GetNodeFromPositionDepth(OctreeNode* start, FVector3f p, int8 depth) const
+OctreeNode** UOctreeCode::GetNodeFromPositionDepth(OctreeNode* start, FVector3f p, int8 depth) const
 {
 	checkSlow(depth <= octree_settings->max_depth)
 
@@ -1413,7 +3192,7 @@ TUniquePtr<OctreeNode>* UOctreeCode::GetNodeFromPositionDepth(OctreeNode* start,
 		parent = current;
 		child_idx = idx;
 
-		current = current->children[idx].Get();
+		current = current->children[idx];
 	}
 
 	return &parent->children[child_idx];
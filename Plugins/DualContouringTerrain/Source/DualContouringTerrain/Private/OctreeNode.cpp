@@ -2,15 +2,214 @@
 
 
 #include "DC_OctreeNode.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/StableSort.h"
 
-OctreeNode::~OctreeNode()
+//blocks are freed without running destructors
+static_assert(TIsTriviallyDestructible<OctreeNode>::Value, "OctreeNode has to stay trivially destructible for OctreeNodeArena");
+
+OctreeNodeArena::~OctreeNodeArena()
+{
+	Release();
+}
+
+OctreeNodeArena::OctreeNodeArena(OctreeNodeArena&& other) noexcept : blocks(MoveTemp(other.blocks)), free_nodes(MoveTemp(other.free_nodes)), block_offset(other.block_offset), num_allocated(other.num_allocated)
+{
+	other.block_offset = nodes_per_block;
+	other.num_allocated = 0;
+}
+
+OctreeNodeArena& OctreeNodeArena::operator=(OctreeNodeArena&& other) noexcept
 {
-	leaf_data.normal = FVector3f();
-	/*for (uint8 i = 0; i < 8; i++)
+	if(this != &other)
 	{
-		delete children[i];
-		children[i] = nullptr;
-	}*/
+		Release();
+
+		blocks = MoveTemp(other.blocks);
+		free_nodes = MoveTemp(other.free_nodes);
+		block_offset = other.block_offset;
+		num_allocated = other.num_allocated;
+
+		other.block_offset = nodes_per_block;
+		other.num_allocated = 0;
+	}
+
+	return *this;
+}
+
+OctreeNode* OctreeNodeArena::Allocate()
+{
+	if(!free_nodes.IsEmpty())
+	{
+		++num_allocated;
+		return new (free_nodes.Pop(EAllowShrinking::No)) OctreeNode();
+	}
+
+	if(block_offset == nodes_per_block)
+	{
+		blocks.Add(static_cast<OctreeNode*>(FMemory::Malloc(sizeof(OctreeNode) * nodes_per_block, alignof(OctreeNode))));
+		block_offset = 0;
+	}
+
+	++num_allocated;
+
+	return new (blocks.Last() + block_offset++) OctreeNode();
+}
+
+void OctreeNodeArena::Free(OctreeNode* node)
+{
+	checkSlow(node);
+
+	free_nodes.Add(node);
+	--num_allocated;
+}
+
+void OctreeNodeArena::FreeSubtree(OctreeNode* node)
+{
+	if(!node) return;
+
+	for (int32 i = 0; i < 8; i++)
+	{
+		FreeSubtree(node->children[i]);
+	}
+
+	Free(node);
+}
+
+void OctreeNodeArena::Append(OctreeNodeArena&& other)
+{
+	checkSlow(this != &other);
+
+	if (blocks.IsEmpty())
+	{
+		blocks = MoveTemp(other.blocks);
+		block_offset = other.block_offset;
+	}
+	else
+	{
+		//keep bump allocating from our own last block, the unused tail of other's last block is left alone
+		blocks.Insert(other.blocks, blocks.Num() - 1);
+		other.blocks.Empty();
+	}
+
+	free_nodes.Append(other.free_nodes);
+	num_allocated += other.num_allocated;
+
+	other.free_nodes.Empty();
+	other.block_offset = nodes_per_block;
+	other.num_allocated = 0;
+}
+
+void OctreeNodeArena::Release()
+{
+	for (int32 i = 0; i < blocks.Num(); i++)
+	{
+		FMemory::Free(blocks[i]);
+	}
+
+	blocks.Empty();
+	free_nodes.Empty();
+	block_offset = nodes_per_block;
+	num_allocated = 0;
+}
+
+void LinearOctree::Reset()
+{
+	nodes.Empty();
+	minimizers.Empty();
+	normals.Empty();
+	qefs.Empty();
+}
+
+SIZE_T LinearOctree::GetAllocatedSize() const
+{
+	return nodes.GetAllocatedSize() + minimizers.GetAllocatedSize() + normals.GetAllocatedSize() + qefs.GetAllocatedSize();
+}
+
+void ProgressiveOctree::Reset()
+{
+	tree.Reset();
+	collapse_errors.Empty();
+	collapse_corners.Empty();
+}
+
+SIZE_T ProgressiveOctree::GetAllocatedSize() const
+{
+	return tree.GetAllocatedSize() + collapse_errors.GetAllocatedSize() + collapse_corners.GetAllocatedSize();
+}
+
+const HermiteData::Edge* HermiteData::Find(uint32 key) const
+{
+	const int32 idx = Algo::LowerBoundBy(edges, key, &Edge::key);
+	return edges.IsValidIndex(idx) && edges[idx].key == key ? &edges[idx] : nullptr;
+}
+
+void HermiteData::Finalize()
+{
+	//stable, so the first voxel that emitted a shared edge wins like it would in a lookup
+	Algo::StableSortBy(edges, &Edge::key);
+
+	int32 num = 0;
+	for (int32 i = 0; i < edges.Num(); i++)
+	{
+		if (num > 0 && edges[num - 1].key == edges[i].key) continue;
+		edges[num++] = edges[i];
+	}
+	edges.SetNum(num, EAllowShrinking::No);
+}
+
+void HermiteData::ReplaceRegion(HermiteData&& rebuilt, const TArray<TPair<FIntVector3, FIntVector3>>& boxes, int32 vox_dim)
+{
+	const int32 dim = vox_dim + 1;
+
+	//an edge belongs to a voxel of the box if it lies within the box along its axis and touches it on the other two
+	auto in_boxes = [&](uint32 key)
+	{
+		const int32 axis = key % 3;
+		const int32 lattice_idx = key / 3;
+		const FIntVector3 c = FIntVector3(lattice_idx / (dim * dim), (lattice_idx / dim) % dim, lattice_idx % dim);
+
+		for (const TPair<FIntVector3, FIntVector3>& box : boxes)
+		{
+			bool inside = true;
+			for (int32 a = 0; a < 3 && inside; a++)
+			{
+				const int32 max = a == axis ? box.Value[a] : box.Value[a] + 1;
+				inside = c[a] >= box.Key[a] && c[a] <= max;
+			}
+			if (inside) return true;
+		}
+		return false;
+	};
+
+	edges.RemoveAll([&](const Edge& edge) { return in_boxes(edge.key); });
+	edges.Append(MoveTemp(rebuilt.edges));
+	Finalize();
+}
+
+void HermiteData::Reset()
+{
+	edges.Empty();
+}
+
+SIZE_T HermiteData::GetAllocatedSize() const
+{
+	return edges.GetAllocatedSize();
+}
+
+void UniformLeafGrid::Reset()
+{
+	dim = 0;
+	active_words.Empty();
+	word_offsets.Empty();
+	minimizers.Empty();
+	normals.Empty();
+	corners.Empty();
+}
+
+SIZE_T UniformLeafGrid::GetAllocatedSize() const
+{
+	return active_words.GetAllocatedSize() + word_offsets.GetAllocatedSize() + minimizers.GetAllocatedSize() + normals.GetAllocatedSize() + corners.GetAllocatedSize();
 }
 
 StitchOctreeNode::~StitchOctreeNode()
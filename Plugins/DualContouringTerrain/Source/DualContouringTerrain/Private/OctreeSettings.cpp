@@ -17,8 +17,39 @@ OctreeSettingsMultithreadContext& OctreeSettingsMultithreadContext::operator=(co
 	simplify = settings.simplify;
 	simplify_threshold = settings.simplify_threshold;
 	normal_fdm_offset = settings.normal_fdm_offset;
+	analytic_gradients = settings.analytic_gradients;
+	batched_qef = settings.batched_qef;
 	stddev_pos = settings.stddev_pos;
 	stddev_normal = settings.stddev_normal;
+	linear_octree = settings.linear_octree;
+	progressive_octree = settings.progressive_octree;
+	parallel_octant_build = settings.parallel_octant_build;
+	uniform_leaf_grid = settings.uniform_leaf_grid;
 
 	return *this;
 }
+
+SettingsInvalidation OctreeSettingsMultithreadContext::GetInvalidation(const OctreeSettingsMultithreadContext& built) const
+{
+	//noise fields are sampled on the max_depth lattice and stored relative to the iso surface
+	if (seed != built.seed || iso_surface != built.iso_surface) return SettingsInvalidation::Noise;
+
+	const bool progressive = progressive_octree && built.progressive_octree;
+	if (max_depth > built.max_depth || (max_depth < built.max_depth && !progressive)) return SettingsInvalidation::Noise;
+
+	if (normal_fdm_offset != built.normal_fdm_offset || analytic_gradients != built.analytic_gradients) return SettingsInvalidation::Hermite;
+
+	//everything the leaf qefs are solved with, and the kind of tree they end up in
+	if (stddev_pos != built.stddev_pos || stddev_normal != built.stddev_normal || batched_qef != built.batched_qef ||
+		progressive_octree != built.progressive_octree || linear_octree != built.linear_octree || uniform_leaf_grid != built.uniform_leaf_grid)
+	{
+		return SettingsInvalidation::Octree;
+	}
+
+	if (max_depth != built.max_depth || simplify != built.simplify || simplify_threshold != built.simplify_threshold)
+	{
+		return progressive ? SettingsInvalidation::Recut : SettingsInvalidation::Octree;
+	}
+
+	return SettingsInvalidation::None;
+}
\ No newline at end of file
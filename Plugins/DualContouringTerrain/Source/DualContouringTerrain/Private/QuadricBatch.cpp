@@ -0,0 +1,231 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DC_QuadricBatch.h"
+
+void QuadricBatch::Init(int32 cell_count)
+{
+	num = cell_count;
+	const int32 padded = Align(cell_count, lanes);
+
+	TArray<float>* coefficients[] = { &A00, &A01, &A02, &A11, &A12, &A22, &b0, &b1, &b2, &c };
+	for (TArray<float>* coefficient : coefficients)
+	{
+		coefficient->SetNumZeroed(padded);
+	}
+
+	//keeps the padding lanes of Solve finite
+	for (int32 i = cell_count; i < padded; i++)
+	{
+		A00[i] = 1.f;
+		A11[i] = 1.f;
+		A22[i] = 1.f;
+	}
+}
+
+void QuadricBatch::AccumulatePlaneQuadrics(const int32* plane_offsets, const uint8* plane_counts, const FVector3f* positions, const FVector3f* normals, float stddev_pos, float stddev_normal)
+{
+	const float sn2 = stddev_normal * stddev_normal;
+	const float sp2 = stddev_pos * stddev_pos;
+
+	const VectorRegister4Float v_sn2 = VectorSetFloat1(sn2);
+	const VectorRegister4Float v_sp2 = VectorSetFloat1(sp2);
+	const VectorRegister4Float v_c_const = VectorSetFloat1(3.f * sp2 * sn2);
+
+	for (int32 cell = 0; cell < num; cell += lanes)
+	{
+		const int32 lane_count = FMath::Min(lanes, num - cell);
+
+		uint8 max_planes = 0;
+		for (int32 l = 0; l < lane_count; l++)
+		{
+			max_planes = FMath::Max(max_planes, plane_counts[cell + l]);
+		}
+
+		VectorRegister4Float a00 = VectorLoad(A00.GetData() + cell), a01 = VectorLoad(A01.GetData() + cell), a02 = VectorLoad(A02.GetData() + cell);
+		VectorRegister4Float a11 = VectorLoad(A11.GetData() + cell), a12 = VectorLoad(A12.GetData() + cell), a22 = VectorLoad(A22.GetData() + cell);
+		VectorRegister4Float vb0 = VectorLoad(b0.GetData() + cell), vb1 = VectorLoad(b1.GetData() + cell), vb2 = VectorLoad(b2.GetData() + cell);
+		VectorRegister4Float vc = VectorLoad(c.GetData() + cell);
+
+		for (uint8 e = 0; e < max_planes; e++)
+		{
+			//transpose plane e of the 4 cells into registers, cells with fewer planes get a zero weight
+			alignas(16) float px[lanes] = {}, py[lanes] = {}, pz[lanes] = {};
+			alignas(16) float nx[lanes] = {}, ny[lanes] = {}, nz[lanes] = {};
+			alignas(16) float w[lanes] = {};
+
+			for (int32 l = 0; l < lane_count; l++)
+			{
+				if (e >= plane_counts[cell + l]) continue;
+
+				const int32 plane = plane_offsets[cell + l] + e;
+				px[l] = positions[plane].X; py[l] = positions[plane].Y; pz[l] = positions[plane].Z;
+				nx[l] = normals[plane].X; ny[l] = normals[plane].Y; nz[l] = normals[plane].Z;
+				w[l] = 1.f;
+			}
+
+			const VectorRegister4Float vpx = VectorLoadAligned(px), vpy = VectorLoadAligned(py), vpz = VectorLoadAligned(pz);
+			const VectorRegister4Float vnx = VectorLoadAligned(nx), vny = VectorLoadAligned(ny), vnz = VectorLoadAligned(nz);
+			const VectorRegister4Float vw = VectorLoadAligned(w);
+			const VectorRegister4Float w_sn2 = VectorMultiply(vw, v_sn2);
+
+			const VectorRegister4Float d = VectorMultiplyAdd(vpx, vnx, VectorMultiplyAdd(vpy, vny, VectorMultiply(vpz, vnz)));
+			const VectorRegister4Float p_dot_p = VectorMultiplyAdd(vpx, vpx, VectorMultiplyAdd(vpy, vpy, VectorMultiply(vpz, vpz)));
+			const VectorRegister4Float n_dot_n = VectorMultiplyAdd(vnx, vnx, VectorMultiplyAdd(vny, vny, VectorMultiply(vnz, vnz)));
+
+			//A = n n^T + sn2 I
+			a00 = VectorMultiplyAdd(VectorMultiplyAdd(vnx, vnx, v_sn2), vw, a00);
+			a01 = VectorMultiplyAdd(VectorMultiply(vnx, vny), vw, a01);
+			a02 = VectorMultiplyAdd(VectorMultiply(vnx, vnz), vw, a02);
+			a11 = VectorMultiplyAdd(VectorMultiplyAdd(vny, vny, v_sn2), vw, a11);
+			a12 = VectorMultiplyAdd(VectorMultiply(vny, vnz), vw, a12);
+			a22 = VectorMultiplyAdd(VectorMultiplyAdd(vnz, vnz, v_sn2), vw, a22);
+
+			//b = n d + p sn2
+			const VectorRegister4Float w_d = VectorMultiply(vw, d);
+			vb0 = VectorMultiplyAdd(vpx, w_sn2, VectorMultiplyAdd(vnx, w_d, vb0));
+			vb1 = VectorMultiplyAdd(vpy, w_sn2, VectorMultiplyAdd(vny, w_d, vb1));
+			vb2 = VectorMultiplyAdd(vpz, w_sn2, VectorMultiplyAdd(vnz, w_d, vb2));
+
+			//c = d^2 + sn2 p.p + sp2 n.n + 3 sp2 sn2
+			const VectorRegister4Float plane_c = VectorMultiplyAdd(d, d, VectorMultiplyAdd(v_sn2, p_dot_p, VectorMultiplyAdd(v_sp2, n_dot_n, v_c_const)));
+			vc = VectorMultiplyAdd(plane_c, vw, vc);
+		}
+
+		VectorStore(a00, A00.GetData() + cell); VectorStore(a01, A01.GetData() + cell); VectorStore(a02, A02.GetData() + cell);
+		VectorStore(a11, A11.GetData() + cell); VectorStore(a12, A12.GetData() + cell); VectorStore(a22, A22.GetData() + cell);
+		VectorStore(vb0, b0.GetData() + cell); VectorStore(vb1, b1.GetData() + cell); VectorStore(vb2, b2.GetData() + cell);
+		VectorStore(vc, c.GetData() + cell);
+	}
+}
+
+void QuadricBatch::AccumulateQuadrics(const quadric3* const* sources, int32 sources_per_cell)
+{
+	for (int32 cell = 0; cell < num; cell += lanes)
+	{
+		const int32 lane_count = FMath::Min(lanes, num - cell);
+
+		VectorRegister4Float a00 = VectorLoad(A00.GetData() + cell), a01 = VectorLoad(A01.GetData() + cell), a02 = VectorLoad(A02.GetData() + cell);
+		VectorRegister4Float a11 = VectorLoad(A11.GetData() + cell), a12 = VectorLoad(A12.GetData() + cell), a22 = VectorLoad(A22.GetData() + cell);
+		VectorRegister4Float vb0 = VectorLoad(b0.GetData() + cell), vb1 = VectorLoad(b1.GetData() + cell), vb2 = VectorLoad(b2.GetData() + cell);
+		VectorRegister4Float vc = VectorLoad(c.GetData() + cell);
+
+		for (int32 s = 0; s < sources_per_cell; s++)
+		{
+			//transpose source s of the 4 cells into registers, missing sources add zero
+			alignas(16) float q[10][lanes] = {};
+			bool any = false;
+
+			for (int32 l = 0; l < lane_count; l++)
+			{
+				const quadric3* source = sources[(cell + l) * sources_per_cell + s];
+				if (!source) continue;
+
+				q[0][l] = source->A00; q[1][l] = source->A01; q[2][l] = source->A02;
+				q[3][l] = source->A11; q[4][l] = source->A12; q[5][l] = source->A22;
+				q[6][l] = source->b0; q[7][l] = source->b1; q[8][l] = source->b2;
+				q[9][l] = source->c;
+				any = true;
+			}
+
+			if (!any) continue;
+
+			a00 = VectorAdd(a00, VectorLoadAligned(q[0])); a01 = VectorAdd(a01, VectorLoadAligned(q[1])); a02 = VectorAdd(a02, VectorLoadAligned(q[2]));
+			a11 = VectorAdd(a11, VectorLoadAligned(q[3])); a12 = VectorAdd(a12, VectorLoadAligned(q[4])); a22 = VectorAdd(a22, VectorLoadAligned(q[5]));
+			vb0 = VectorAdd(vb0, VectorLoadAligned(q[6])); vb1 = VectorAdd(vb1, VectorLoadAligned(q[7])); vb2 = VectorAdd(vb2, VectorLoadAligned(q[8]));
+			vc = VectorAdd(vc, VectorLoadAligned(q[9]));
+		}
+
+		VectorStore(a00, A00.GetData() + cell); VectorStore(a01, A01.GetData() + cell); VectorStore(a02, A02.GetData() + cell);
+		VectorStore(a11, A11.GetData() + cell); VectorStore(a12, A12.GetData() + cell); VectorStore(a22, A22.GetData() + cell);
+		VectorStore(vb0, b0.GetData() + cell); VectorStore(vb1, b1.GetData() + cell); VectorStore(vb2, b2.GetData() + cell);
+		VectorStore(vc, c.GetData() + cell);
+	}
+}
+
+void QuadricBatch::Solve(FVector3f* minimizers, float* errors) const
+{
+	const VectorRegister4Float one = VectorOneFloat();
+	const VectorRegister4Float two = VectorSetFloat1(2.f);
+
+	for (int32 cell = 0; cell < num; cell += lanes)
+	{
+		const VectorRegister4Float a00 = VectorLoad(A00.GetData() + cell);
+		const VectorRegister4Float a10 = VectorLoad(A01.GetData() + cell);
+		const VectorRegister4Float a20 = VectorLoad(A02.GetData() + cell);
+		VectorRegister4Float a11 = VectorLoad(A11.GetData() + cell);
+		VectorRegister4Float a21 = VectorLoad(A12.GetData() + cell);
+		VectorRegister4Float a22 = VectorLoad(A22.GetData() + cell);
+		const VectorRegister4Float r0 = VectorLoad(b0.GetData() + cell);
+		const VectorRegister4Float r1 = VectorLoad(b1.GetData() + cell);
+		const VectorRegister4Float r2 = VectorLoad(b2.GetData() + cell);
+
+		//unrolled cholesky, the same steps as quadric3::minimizer
+		const VectorRegister4Float d0 = VectorDivide(one, a00);
+		const VectorRegister4Float l10 = VectorNegate(VectorMultiply(a10, d0));
+		const VectorRegister4Float l20 = VectorNegate(VectorMultiply(a20, d0));
+
+		a11 = VectorMultiplyAdd(a10, l10, a11);
+		a21 = VectorMultiplyAdd(a20, l10, a21);
+		a22 = VectorMultiplyAdd(a20, l20, a22);
+
+		const VectorRegister4Float d1 = VectorDivide(one, a11);
+		const VectorRegister4Float l21 = VectorNegate(VectorMultiply(a21, d1));
+		a22 = VectorMultiplyAdd(a21, l21, a22);
+
+		const VectorRegister4Float d2 = VectorDivide(one, a22);
+
+		VectorRegister4Float x0 = r0;
+		VectorRegister4Float x1 = VectorMultiplyAdd(l10, x0, r1);
+		VectorRegister4Float x2 = VectorMultiplyAdd(l20, x0, r2);
+		x2 = VectorMultiplyAdd(l21, x1, x2);
+
+		x0 = VectorMultiply(x0, d0);
+		x1 = VectorMultiply(x1, d1);
+		x2 = VectorMultiply(x2, d2);
+
+		x0 = VectorMultiplyAdd(l20, x2, x0);
+		x1 = VectorMultiplyAdd(l21, x2, x1);
+		x0 = VectorMultiplyAdd(l10, x1, x0);
+
+		alignas(16) float mx[lanes], my[lanes], mz[lanes];
+		VectorStoreAligned(x0, mx);
+		VectorStoreAligned(x1, my);
+		VectorStoreAligned(x2, mz);
+
+		const int32 lane_count = FMath::Min(lanes, num - cell);
+		for (int32 l = 0; l < lane_count; l++)
+		{
+			minimizers[cell + l] = FVector3f(mx[l], my[l], mz[l]);
+		}
+
+		if (!errors) continue;
+
+		//x^T A x - 2 b^T x + c against the unfactored coefficients
+		const VectorRegister4Float q01 = VectorLoad(A01.GetData() + cell);
+		const VectorRegister4Float q02 = VectorLoad(A02.GetData() + cell);
+		const VectorRegister4Float q12 = VectorLoad(A12.GetData() + cell);
+
+		const VectorRegister4Float ax0 = VectorMultiplyAdd(a00, x0, VectorMultiplyAdd(q01, x1, VectorMultiply(q02, x2)));
+		const VectorRegister4Float ax1 = VectorMultiplyAdd(q01, x0, VectorMultiplyAdd(VectorLoad(A11.GetData() + cell), x1, VectorMultiply(q12, x2)));
+		const VectorRegister4Float ax2 = VectorMultiplyAdd(q02, x0, VectorMultiplyAdd(q12, x1, VectorMultiply(VectorLoad(A22.GetData() + cell), x2)));
+
+		const VectorRegister4Float x_ax = VectorMultiplyAdd(x0, ax0, VectorMultiplyAdd(x1, ax1, VectorMultiply(x2, ax2)));
+		const VectorRegister4Float b_x = VectorMultiplyAdd(r0, x0, VectorMultiplyAdd(r1, x1, VectorMultiply(r2, x2)));
+		const VectorRegister4Float error = VectorAdd(VectorSubtract(x_ax, VectorMultiply(two, b_x)), VectorLoad(c.GetData() + cell));
+
+		alignas(16) float e[lanes];
+		VectorStoreAligned(error, e);
+		for (int32 l = 0; l < lane_count; l++)
+		{
+			errors[cell + l] = e[l];
+		}
+	}
+}
+
+quadric3 QuadricBatch::Get(int32 cell) const
+{
+	checkSlow(cell < num);
+
+	return quadric3::from_coefficients(A00[cell], A01[cell], A02[cell], A11[cell], A12[cell], A22[cell], b0[cell], b1[cell], b2[cell], c[cell]);
+}
@@ -0,0 +1,217 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Misc/AutomationTest.h"
+#include "DC_QuadricBatch.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace QuadricBatchTest
+{
+	enum class EPlaneSet : uint8
+	{
+		Random,
+		//all normals of a cell parallel, only the regularization keeps A invertible
+		Parallel,
+		//normals of a cell spread by a tiny angle around one direction
+		NearlyParallel,
+	};
+
+	FVector3f RandomUnitVector(FRandomStream& random)
+	{
+		return FVector3f(random.GetUnitVector());
+	}
+
+	void BuildPlanes(FRandomStream& random, EPlaneSet plane_set, int32 cell_count, TArray<int32>& plane_offsets, TArray<uint8>& plane_counts, TArray<FVector3f>& positions, TArray<FVector3f>& normals)
+	{
+		plane_offsets.SetNumUninitialized(cell_count);
+		plane_counts.SetNumUninitialized(cell_count);
+		positions.Reset();
+		normals.Reset();
+
+		for (int32 cell = 0; cell < cell_count; cell++)
+		{
+			//every cell gets at least one plane, an empty quadric has no minimizer to compare
+			const uint8 count = (uint8)random.RandRange(1, 12);
+			const FVector3f cell_origin(random.RandRange(0, 31), random.RandRange(0, 31), random.RandRange(0, 31));
+			const FVector3f cell_normal = RandomUnitVector(random);
+
+			plane_offsets[cell] = positions.Num();
+			plane_counts[cell] = count;
+
+			for (uint8 e = 0; e < count; e++)
+			{
+				positions.Add(cell_origin + FVector3f(random.GetFraction(), random.GetFraction(), random.GetFraction()));
+
+				switch (plane_set)
+				{
+				case EPlaneSet::Random:
+					normals.Add(RandomUnitVector(random));
+					break;
+				case EPlaneSet::Parallel:
+					normals.Add(cell_normal);
+					break;
+				case EPlaneSet::NearlyParallel:
+					normals.Add((cell_normal + RandomUnitVector(random) * 1e-3f).GetSafeNormal());
+					break;
+				}
+			}
+		}
+	}
+
+	bool CoefficientsMatch(const quadric3& a, const quadric3& b, float tolerance)
+	{
+		const float coefficients_a[] = { a.A00, a.A01, a.A02, a.A11, a.A12, a.A22, a.b0, a.b1, a.b2, a.c };
+		const float coefficients_b[] = { b.A00, b.A01, b.A02, b.A11, b.A12, b.A22, b.b0, b.b1, b.b2, b.c };
+
+		for (int32 i = 0; i < UE_ARRAY_COUNT(coefficients_a); i++)
+		{
+			if (!FMath::IsNearlyEqual(coefficients_a[i], coefficients_b[i], tolerance * FMath::Max(1.f, FMath::Abs(coefficients_b[i])))) return false;
+		}
+
+		return true;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FQuadricBatchPlaneQuadricsTest, "DualContouringTerrain.QuadricBatch.PlaneQuadricsMatchScalar", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FQuadricBatchPlaneQuadricsTest::RunTest(const FString& Parameters)
+{
+	using namespace QuadricBatchTest;
+
+	FRandomStream random(1337);
+
+	//cell counts that are no multiple of the lane count leave padded tail lanes
+	const int32 cell_counts[] = { 1, 3, 4, 5, 7, 13, 64, 257 };
+	const EPlaneSet plane_sets[] = { EPlaneSet::Random, EPlaneSet::Parallel, EPlaneSet::NearlyParallel };
+	const float stddevs[] = { 0.01f, 0.1f };
+
+	TArray<int32> plane_offsets;
+	TArray<uint8> plane_counts;
+	TArray<FVector3f> positions;
+	TArray<FVector3f> normals;
+
+	for (const EPlaneSet plane_set : plane_sets)
+	{
+		for (const int32 cell_count : cell_counts)
+		{
+			for (const float stddev : stddevs)
+			{
+				BuildPlanes(random, plane_set, cell_count, plane_offsets, plane_counts, positions, normals);
+
+				QuadricBatch batch;
+				batch.Init(cell_count);
+				batch.AccumulatePlaneQuadrics(plane_offsets.GetData(), plane_counts.GetData(), positions.GetData(), normals.GetData(), stddev, stddev);
+
+				//one sentinel past the end, Solve must not write the padding lanes back
+				const FVector3f sentinel(-1234.f);
+				TArray<FVector3f> minimizers;
+				minimizers.Init(sentinel, cell_count + 1);
+				TArray<float> errors;
+				errors.Init(-1234.f, cell_count + 1);
+
+				batch.Solve(minimizers.GetData(), errors.GetData());
+
+				TestTrue(TEXT("Solve leaves the minimizers past the cell count untouched"), minimizers[cell_count] == sentinel);
+				TestTrue(TEXT("Solve leaves the errors past the cell count untouched"), errors[cell_count] == -1234.f);
+
+				for (int32 cell = 0; cell < cell_count; cell++)
+				{
+					quadric3 scalar_q;
+					for (uint8 e = 0; e < plane_counts[cell]; e++)
+					{
+						const int32 plane = plane_offsets[cell] + e;
+						scalar_q += quadric3::probabilistic_plane_quadric(positions[plane], normals[plane], stddev, stddev);
+					}
+
+					const FVector3f scalar_minimizer = scalar_q.minimizer();
+					const float scalar_error = scalar_q(scalar_minimizer);
+					const FVector3f& batch_minimizer = minimizers[cell];
+
+					const FString context = FString::Printf(TEXT("plane set %d, %d cells, stddev %f, cell %d"), (int32)plane_set, cell_count, stddev, cell);
+
+					if (!CoefficientsMatch(batch.Get(cell), scalar_q, 1e-4f))
+					{
+						AddError(FString::Printf(TEXT("accumulated coefficients differ from the scalar quadric (%s)"), *context));
+					}
+
+					//ill conditioned cells may move the minimizer along the flat directions, there only the residual has to agree
+					const float position_tolerance = 1e-3f * FMath::Max(1.f, scalar_minimizer.GetAbsMax());
+					//the residual cancels terms of the size of c, so float rounding scales with c rather than with the result
+					const float error_tolerance = 1e-3f * FMath::Max(1.f, FMath::Abs(scalar_error)) + 1e-5f * FMath::Abs(scalar_q.c);
+					const bool well_conditioned = plane_set == EPlaneSet::Random;
+
+					if (well_conditioned && !batch_minimizer.Equals(scalar_minimizer, position_tolerance))
+					{
+						AddError(FString::Printf(TEXT("minimizer %s differs from the scalar %s (%s)"), *batch_minimizer.ToString(), *scalar_minimizer.ToString(), *context));
+					}
+
+					if (!FMath::IsNearlyEqual(scalar_q(batch_minimizer), scalar_error, error_tolerance))
+					{
+						AddError(FString::Printf(TEXT("residual %f at the minimizer differs from the scalar %f (%s)"), scalar_q(batch_minimizer), scalar_error, *context));
+					}
+
+					if (!FMath::IsNearlyEqual(errors[cell], scalar_error, error_tolerance))
+					{
+						AddError(FString::Printf(TEXT("error %f differs from the scalar %f (%s)"), errors[cell], scalar_error, *context));
+					}
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FQuadricBatchAccumulateQuadricsTest, "DualContouringTerrain.QuadricBatch.AccumulateQuadricsMatchScalar", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FQuadricBatchAccumulateQuadricsTest::RunTest(const FString& Parameters)
+{
+	using namespace QuadricBatchTest;
+
+	FRandomStream random(4242);
+
+	constexpr int32 sources_per_cell = 8;
+	const int32 cell_counts[] = { 1, 6, 11 };
+
+	for (const int32 cell_count : cell_counts)
+	{
+		TArray<quadric3> source_quadrics;
+		source_quadrics.SetNum(cell_count * sources_per_cell);
+
+		TArray<const quadric3*> sources;
+		sources.SetNumZeroed(cell_count * sources_per_cell);
+
+		for (int32 i = 0; i < sources.Num(); i++)
+		{
+			//some children are missing, like the empty ones of a collapsed node
+			if (random.FRand() < 0.25f) continue;
+
+			const FVector3f pos(random.FRandRange(0.f, 32.f), random.FRandRange(0.f, 32.f), random.FRandRange(0.f, 32.f));
+			source_quadrics[i] = quadric3::probabilistic_plane_quadric(pos, RandomUnitVector(random), 0.01f, 0.01f);
+			sources[i] = &source_quadrics[i];
+		}
+
+		QuadricBatch batch;
+		batch.Init(cell_count);
+		batch.AccumulateQuadrics(sources.GetData(), sources_per_cell);
+
+		for (int32 cell = 0; cell < cell_count; cell++)
+		{
+			quadric3 scalar_q;
+			for (int32 s = 0; s < sources_per_cell; s++)
+			{
+				if (const quadric3* source = sources[cell * sources_per_cell + s]) scalar_q += *source;
+			}
+
+			if (!CoefficientsMatch(batch.Get(cell), scalar_q, 1e-4f))
+			{
+				AddError(FString::Printf(TEXT("accumulated coefficients differ from the scalar sum (%d cells, cell %d)"), cell_count, cell));
+			}
+		}
+	}
+
+	return true;
+}
+
+#endif
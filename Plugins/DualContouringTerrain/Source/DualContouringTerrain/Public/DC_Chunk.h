@@ -5,7 +5,10 @@
 #include "CoreMinimal.h"
 #include "DC_OctreeNode.h"
 #include "Interface/Core/RealtimeMeshInterfaceFwd.h"
+#include "Interface/Core/RealtimeMeshDataStream.h"
 #include "DC_SDFOps.h"
+#include "DC_ChunkProviderSettings.h"
+#include "DC_ChunkRegionCache.h"
 
 enum class PolygonizeTaskArg : uint8
 {
@@ -13,33 +16,109 @@ enum class PolygonizeTaskArg : uint8
 	SlabNegative = 1,
 	SlabPositive = 2,
 	RebuildAllSeams = 3,
+	//re-stitch the seam strips the chunk already owns, its own tree did not change
+	SeamsOnly = 4,
 };
 
 enum class CreationTaskArg : uint8
 {
 	Update = 0,
 	NewlyCreated = 1,
-	ModifyOperation = 2
+	ModifyOperation = 2,
+	//resample at the chunk's new lod depth, its sdf ops are applied again
+	LodChange = 3,
+	//cut the chunk's progressive octree again, nothing is sampled
+	Recut = 4,
+	//build the chunk's tree again from its stored noise field, normals come from its hermite data where it holds any
+	Rederive = 5,
+	//build the chunk from its region cache record, nothing is sampled
+	Restore = 6
+};
+
+// density samples of a chunk, optionally quantized relative to the iso surface.
+// quantized samples never change side of the iso surface, so corner signs survive a round trip.
+struct DUALCONTOURINGTERRAIN_API ChunkNoiseField
+{
+public:
+	void Encode(TArray<float>&& field, NoiseFieldStorage new_storage, float new_iso_surface, float new_range);
+	void Decode(TArray<float>& out) const;
+	float Get(int32 idx) const;
+	void Reset();
+	// stored as is, quantized fields stay quantized
+	void Serialize(FArchive& ar);
+
+	FORCEINLINE int32 Num() const { return num; }
+	// quantized samples are clamped to the range, they are not the noise they were sampled from
+	FORCEINLINE bool IsQuantized() const { return storage != NoiseFieldStorage::Raw; }
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	TArray<float> raw;
+	TArray<int16> quantized_16;
+	TArray<int8> quantized_8;
+	NoiseFieldStorage storage = NoiseFieldStorage::Raw;
+	float iso_surface = 0.f;
+	float range = 1.f;
+	int32 num = 0;
 };
 
 struct DUALCONTOURINGTERRAIN_API ChunkCreationResult
 {
 	FIntVector3 chunk_coord;
 	bool chunk_update = false;
-	TUniquePtr<OctreeNode> created_root = nullptr;
-	TArray<float> noise_field;
+	OctreeNode* created_root = nullptr;
+	OctreeNodeArena node_arena;
+	LinearOctree created_linear_tree;
+	ProgressiveOctree created_progressive_tree;
+	UniformLeafGrid created_leaf_grid;
+	RealtimeMesh::FRealtimeMeshStreamSet created_interior;
+	ChunkNoiseField noise_field;
+	HermiteData hermite;
+	//only the cut and its interior are new, the chunk keeps its noise field, progressive octree and hermite data
+	bool recut = false;
+	//built from the chunk's stored noise field, which it keeps
+	bool rederived = false;
+	//built from a region cache record, the chunk takes its edits from it
+	bool restored = false;
+	TArray<FSDFOp> sdf_ops;
 
 	ChunkCreationResult() = default;
 };
 
 struct DUALCONTOURINGTERRAIN_API ChunkPolygonizeResult
 {
-	TFuture<ERealtimeMeshProxyUpdateStatus> mesh_future;
-	TFuture<ERealtimeMeshProxyUpdateStatus> collision_future;
+	//one per uploaded / removed section group
+	TArray<TFuture<ERealtimeMeshProxyUpdateStatus>, TInlineAllocator<3>> mesh_futures;
+	TArray<TFuture<ERealtimeMeshProxyUpdateStatus>, TInlineAllocator<3>> collision_futures;
 	FIntVector3 chunk_coord;
 	bool rm_aborted = false;
 
 	ChunkPolygonizeResult() = default;
+
+	bool IsReady() const
+	{
+		for (const auto& future : mesh_futures) if (!future.IsReady()) return false;
+		for (const auto& future : collision_futures) if (!future.IsReady()) return false;
+		return true;
+	}
+};
+
+struct DUALCONTOURINGTERRAIN_API ChunkCreationJob
+{
+	FIntVector3 chunk_coord;
+	CreationTaskArg task_arg = CreationTaskArg::Update;
+	//only used by ModifyOperation jobs
+	FSDFOp sdf_op;
+	float priority = 0.f;
+};
+
+// polygonize job that still waits on the creation of its chunk or of neighbours its seams reach
+struct DUALCONTOURINGTERRAIN_API PolygonizeJobNode
+{
+	FIntVector3 chunk_coord;
+	PolygonizeTaskArg task_arg = PolygonizeTaskArg::Area;
+	int32 pending_dependencies = 0;
+	float priority = 0.f;
 };
 
 class URealtimeMeshSimple;
@@ -57,13 +136,39 @@ public:
 
 	Chunk& operator=(Chunk&& other) noexcept;
 
-	TUniquePtr<struct OctreeNode> root = nullptr;
+	//points into node_arena
+	OctreeNode* root = nullptr;
+	OctreeNodeArena node_arena;
+	//used instead of root when the linear octree setting is on
+	LinearOctree linear_tree;
+	//with the progressive octree setting on, linear_tree is cut from this one
+	ProgressiveOctree progressive_tree;
+	//used instead of both when simplification is off and the uniform leaf grid setting is on
+	UniformLeafGrid leaf_grid;
+	//vertices and quads inside the chunk, handed to the next polygonize task as its own section group
+	RealtimeMesh::FRealtimeMeshStreamSet interior_streams;
+	bool interior_pending = false;
+	//bit negative_delta set for every seam strip section group the chunk's mesh holds
+	uint8 seam_groups = 0;
 	FVector3f center;
+	//octree depth the chunk was sampled and built at, max_depth unless lod rings are on
+	int32 depth = 0;
+	//depth the surface is cut at, below depth once a lod change recut the progressive tree
+	int32 cut_depth = 0;
 	bool rmc_newly_created = false;
 	bool has_section_built = false;
-	uint8 ping_counter = 0;
 	URealtimeMeshSimple* mesh = nullptr;
-	TArray<float> noise_field;
+	ChunkNoiseField noise_field;
+	//edge intersections and normals of the surface, only kept with the keep hermite data setting on
+	HermiteData hermite;
 	TArray<FSDFOp> sdf_ops;
+	//the region cache holds this chunk as it is, evicting it writes nothing
+	bool cache_clean = false;
+	//neighbour depths the noise field was snapped against, see ChunkCacheHeader
+	uint32 lod_key = 0;
+
+	FORCEINLINE bool HasSurface() const { return root || !linear_tree.IsEmpty() || !leaf_grid.IsEmpty(); }
+	// trees, noise field, hermite data, edits and interior streams
+	SIZE_T GetAllocatedSize() const;
 };
 
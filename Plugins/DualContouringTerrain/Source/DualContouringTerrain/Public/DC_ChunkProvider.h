@@ -6,7 +6,11 @@
 #include "Subsystems/WorldSubsystem.h"
 #include "DC_Chunk.h"
 #include "DC_ChunkProviderSettings.h"
+#include "DC_OctreeSettings.h"
+#include "DC_ChunkRegionCache.h"
 #include "Misc/Optional.h"
+#include "Containers/StaticArray.h"
+#include "Containers/List.h"
 #include "DC_SDFOps.h"
 #include "DC_ChunkProvider.generated.h"
 /**
@@ -14,6 +18,7 @@
  */
 class UOctreeCode;
 struct OctreeNode;
+struct LinearOctree;
 class ADC_OctreeRenderActor;
 class URealtimeMeshSimple;
 
@@ -33,40 +38,91 @@ private:
 
 	void ReloadChunks();
 	void ReloadReallocChunks();
+	// brings every chunk up to the current settings from what it kept, cutting its progressive octree again or rebuilding its tree, and re-polygonizes it
+	void RederiveChunks(SettingsInvalidation invalidation);
 
 	//alloc funcs
 	void Init(bool simulating);
 	void Cleanup(bool simulating);
 
+	// fixed capacity toroidal grid, a chunk lives in the slot of its coordinate modulo ring_dim.
+	// slots never move while the world scrolls, pointers to chunks stay valid until the next Realloc.
 	struct ChunkGrid
 	{
 	public:
 		Chunk* TryGet(FIntVector3 c);
 		const Chunk& Get(FIntVector3 c);
 		Chunk& GetMutable(FIntVector3 c);
+		bool Contains(FIntVector3 c) const;
+
+		Chunk& Add(FIntVector3 c, Chunk&& chunk);
+		void Remove(FIntVector3 c);
+		//true if the slot of c holds a chunk with another coordinate
+		bool GetSlotOccupant(FIntVector3 c, FIntVector3& occupant) const;
+
+		template<typename FuncType>
+		void ForEachChunk(FuncType&& func)
+		{
+			for (TConstSetBitIterator<> it(slot_used); it; ++it)
+			{
+				func(slot_coords[it.GetIndex()], slots[it.GetIndex()]);
+			}
+		}
+
+		FORCEINLINE int32 Num() const { return num_chunks; }
 
 		//waits until everything is finished and cleans up chunk resources
 		void Cleanup();
 
-		void Realloc(int32 new_load_distance);
+		void Realloc(int32 new_load_distance, int32 ping_deletion_at);
 
-		TMap<FIntVector3, Chunk> chunks;
+		//binary heap on priority, re-ranked every tick
+		TArray<ChunkCreationJob> chunk_creation_jobs;
+		//pushed by the pool threads when a creation task finishes, drained on the game thread
+		TQueue<ChunkCreationResult, EQueueMode::Mpsc> chunk_creation_results;
+		int32 creation_tasks_in_flight = 0;
+		//queued or running creation tasks per chunk
+		TMap<FIntVector3, int32> pending_creations;
+		//creations dropped while the camera was away from them, queued again once idle if the area still holds them
+		TSet<FIntVector3> dropped_creations;
 
-		TQueue<TTuple<FIntVector3, CreationTaskArg>> chunk_creation_jobs;
-		TArray<TFuture<ChunkCreationResult>> chunk_creation_tasks;
 		TQueue<TTuple<FIntVector3, PolygonizeTaskArg>> chunk_polygonize_jobs;
+		//polygonize jobs waiting on creation tasks, and which of them each pending chunk unblocks
+		TSparseArray<PolygonizeJobNode> polygonize_graph;
+		TMap<FIntVector3, TArray<int32, TInlineAllocator<8>>> creation_dependents;
+		//heap like chunk_creation_jobs
+		TArray<PolygonizeJobNode> ready_polygonize_jobs;
 		TArray<TFuture<ChunkPolygonizeResult>> chunk_polygonize_tasks;
 
-		TQueue<FSDFOp> modify_operations;
-
 		int32 dim;
+		//load area plus room for chunks waiting on their ping deletion
+		int32 ring_dim = 0;
 		FIntVector min_coord;
 		FIntVector3 current_generator_pos;
+
+		//sorted by distance once per Realloc
+		TArray<FIntVector3> area_offsets;
+		//chunks that left the area, tagged with the generator step they left at
+		TArray<TTuple<int32, TArray<FIntVector3>>> left_slabs;
+		int32 generator_steps = 0;
+
+		//center of the lod rings, the generator position snapped to the ring width
+		FIntVector3 lod_center;
 	private:
 		FORCEINLINE int32 Flatten(int32 x, int32 y, int32 z) const
 		{
-			return z + (y * dim) + (x * dim * dim);
+			return z + (y * ring_dim) + (x * ring_dim * ring_dim);
 		};
+
+		FORCEINLINE int32 GetSlot(const FIntVector3& c) const
+		{
+			return Flatten(((c.X % ring_dim) + ring_dim) % ring_dim, ((c.Y % ring_dim) + ring_dim) % ring_dim, ((c.Z % ring_dim) + ring_dim) % ring_dim);
+		};
+
+		TArray<Chunk> slots;
+		TArray<FIntVector3> slot_coords;
+		TBitArray<> slot_used;
+		int32 num_chunks = 0;
 	} chunk_grid;
 
 
@@ -80,37 +136,114 @@ private:
 
 	void BuildChunkArea(FIntVector3 current_chunk_coord);
 	void BuildSlabs(FIntVector3 delta, FIntVector3 current_chunk_coord);
-	TArray<FIntVector3> GetChunkArea(FIntVector3 around);
-
-	TArray<float> BuildNoiseField(const FVector3f& center, float size, int32 max_depth, int32 noise_seed);
+	// remembers the slab the generator just left and deletes chunks that stayed out of the area for chunk_ping_deletion_at steps
+	void EvictSlabs(FIntVector3 delta, FIntVector3 previous_generator_pos);
+
+	// game thread: copies the boundary planes shared with loaded, unedited neighbours into noise and narrows the box left to sample
+	void CopyNoiseFieldBoundaries(const FIntVector3& coord, int32 dim, TArray<float>& noise, FIntVector3& sample_min, FIntVector3& sample_max);
+	// samples the inclusive box [sample_min, sample_max] of the chunk's noise field
+	static void BuildNoiseField(TArray<float>& noise, const FIntVector3& coord, const FIntVector3& sample_min, const FIntVector3& sample_max, int32 max_depth, int32 noise_seed);
+	// builds the tree / grid the settings ask for into result, sdf_ops and hermite may be null
+	static void BuildChunkTree(ChunkCreationResult& result, const FVector3f& center, float size, const OctreeSettingsMultithreadContext& settings_context, const TArray<float>& noise_field, const TArray<FSDFOp>* sdf_ops, int32 depth_cut, HermiteData* hermite);
+	// meshes the inside of whatever tree / grid the creation task just built, still on the worker
+	static void PolygonizeChunkInterior(ChunkCreationResult& result);
 	void EditNoiseField(TArray<float>& noise_field, const FVector3f& center, float size, int32 max_depth, const FSDFOp& sdf_op);
+	// boundary samples shared with a coarser chunk are replaced by the interpolation of the coarsest one's samples, so both sides agree on every sign change.
+	// neighbor_depths is indexed by (x + 1) * 9 + (y + 1) * 3 + (z + 1) of the neighbour offset
+	static void SnapNoiseFieldBoundaries(TArray<float>& noise, int32 depth, const TStaticArray<int32, 27>& neighbor_depths);
+
+	// octree depth of the chunk at coord for the current lod rings
+	int32 GetChunkDepth(const FIntVector3& coord) const;
+	// depths of coord and its 26 neighbours for the current lod rings, indexed like SnapNoiseFieldBoundaries expects
+	void GetNeighborDepths(const FIntVector3& coord, TStaticArray<int32, 27>& neighbor_depths) const;
+	// lod key a chunk at coord sampled at depth gets against the current lod rings, 0 without lod rings
+	uint32 GetChunkLodKey(const FIntVector3& coord, int32 depth) const;
+	FIntVector3 GetLodCenter(const FIntVector3& generator_pos) const;
+	// moves the lod rings along with the generator, chunks that change depth are rebuilt together with the neighbours sharing their boundary
+	void UpdateChunkLods();
+	// builds the dropped creations the area still holds and the camera is back in reach of, false if none was queued
+	bool RequeueDroppedCreations();
 
 	//calls upon octree manager to mesh this chunk.
 	void MeshChunk(const FIntVector3& coords, PolygonizeTaskArg task_arg);
 	void CreateChunk(FIntVector3 coord);
-	void RebuildChunk(FIntVector3 coord);
+	void RebuildChunk(FIntVector3 coord, const FSDFOp& sdf_op);
+	// coarser cuts of a progressive tree whose neighbours kept their depths are recut, anything else is resampled
+	void RebuildChunkLod(FIntVector3 coord);
 
 	bool IsSafeToModifyChunks();
 
  	void FillSeamOctreeNodes(TArray<OctreeNode*, TInlineAllocator<8>>& seam_octants, bool negative_delta, const FIntVector3& chunk_coord, OctreeNode* root);
+	void FillSeamOctreeNodes(TArray<const LinearOctree*, TInlineAllocator<8>>& seam_trees, bool negative_delta, const FIntVector3& chunk_coord, const LinearOctree* tree);
+	void FillSeamOctreeNodes(TArray<const UniformLeafGrid*, TInlineAllocator<8>>& seam_grids, bool negative_delta, const FIntVector3& chunk_coord, const UniformLeafGrid* grid);
 
 	void DrainChunkBuildQueues();
+	void DispatchCreationTask(const ChunkCreationJob& job);
+	void DispatchPolygonizeTask(const FIntVector3& coord, PolygonizeTaskArg task_arg);
+	// called once per finished or dropped creation task, hands polygonize jobs without pending creations to the ready heap
+	void ResolveCreationDependency(const FIntVector3& coord);
+	// lower runs first: distance to the camera, scaled up outside of the view cone
+	float GetJobPriority(const FIntVector3& coord, const FIntVector3& camera_coord, int32 load_dist) const;
 
 	void ReleaseChunkMesh(Chunk& chunk);
 
+	// hands a chunk that is about to be removed to the region cache, its noise field, edits and hermite data are moved out and compressed on the pool
+	void CacheChunk(const FIntVector3& coord, Chunk& chunk);
+	// drops the evicted chunks into the region cache, then caches every loaded chunk without a creation task and waits until all of them are written
+	void CacheLoadedChunks();
+	// takes the chunk out of the grid and its mesh back to the pool, the chunk itself goes to the evicted chunks or the region cache
+	void EvictChunk(const FIntVector3& coord);
+	// puts an evicted chunk back into the grid as it left, false if there is none for coord
+	bool ReviveChunk(const FIntVector3& coord);
+	// hands the least recently evicted chunks to the region cache until the rest fits in budget bytes
+	void TrimEvictedChunks(SIZE_T budget);
+	// hands the records the pool compressed to the region cache and starts its flushes, wait blocks until none is left in flight
+	void DrainCacheWrites(bool wait);
+	// everything a cached noise field depends on, taken whenever every chunk is sampled again
+	uint32 GetCacheNoiseHash(const OctreeSettingsMultithreadContext& settings) const;
+	// everything cached normals depend on
+	static uint32 GetCacheHermiteHash(const OctreeSettingsMultithreadContext& settings);
+
 	// try to get current render camera
 	FVector GetActiveCameraLocation();
+	FVector GetActiveCameraForward();
 
 	FVector camera_pos = FVector();
+	FVector camera_forward = FVector::ForwardVector;
 
 	//TArray<UE::Math::TBox<float>> ops;
 
 	// actor for rendering the octree mesh
 	ADC_OctreeRenderActor* render_actor = nullptr;
 	bool build_initial_area = false;
+	//set by a settings change the kept chunk data can absorb, handled once no task is in flight
+	SettingsInvalidation pending_invalidation = SettingsInvalidation::None;
+	//settings the loaded chunks were built with
+	OctreeSettingsMultithreadContext built_settings;
+	//noise hash of built_settings and the chunk provider settings the loaded chunks were sampled with
+	uint32 built_noise_hash = 0;
+
+	ChunkRegionCache region_cache;
+	//records compressed on the pool, handed to the region cache on the game thread
+	TQueue<TTuple<FIntVector3, ChunkCacheRecord>, EQueueMode::Mpsc> cache_writes;
+	//chunks whose record is still being compressed, their restore jobs wait for it
+	TSet<FIntVector3> pending_cache_writes;
+
+	struct EvictedChunk
+	{
+		Chunk chunk;
+		SIZE_T allocated_size = 0;
+		TDoubleLinkedList<FIntVector3>::TDoubleLinkedListNode* lru_node = nullptr;
+	};
+	//chunks that left the ring, kept until evicted_chunk_budget_mb runs out
+	TMap<FIntVector3, EvictedChunk> evicted_chunks;
+	//least recently evicted first
+	TDoubleLinkedList<FIntVector3> evicted_lru;
+	SIZE_T evicted_bytes = 0;
 	TSet<FIntVector3> temp_created_chunks;
 
 	FQueuedThreadPool* thread_pool = nullptr;
+	int32 pool_thread_num = 1;
 
 	virtual void Tick(float DeltaTime) override;
 	TStatId GetStatId() const override;
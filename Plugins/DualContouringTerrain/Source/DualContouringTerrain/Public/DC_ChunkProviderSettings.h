@@ -6,6 +6,14 @@
 #include "Engine/DeveloperSettings.h"
 #include "DC_ChunkProviderSettings.generated.h"
 
+UENUM()
+enum class NoiseFieldStorage : uint8
+{
+	Raw,
+	Quantized16,
+	Quantized8
+};
+
 /**
  * 
  */
@@ -27,6 +35,47 @@ public:
 	UPROPERTY(Config, EditAnywhere, meta = (NoRebuild = "true"))
 	bool stop_chunk_loading = false;
 
+	// tasks handed to the thread pool at once per thread, queued jobs past that are re-ranked every tick
+	UPROPERTY(Config, EditAnywhere, Category = "Scheduling", meta = (NoRebuild = "true", ClampMin = 1))
+	int32 jobs_in_flight_per_thread = 2;
+
+	// full opening angle of the cone in front of the camera whose chunks are built first
+	UPROPERTY(Config, EditAnywhere, Category = "Scheduling", meta = (NoRebuild = "true", ClampMin = 1, ClampMax = 360))
+	float priority_view_cone_angle = 110.f;
+
+	// chunks outside of the view cone are ranked as if they were this much further away
+	UPROPERTY(Config, EditAnywhere, Category = "Scheduling", meta = (NoRebuild = "true", ClampMin = 1))
+	float out_of_view_priority_scale = 4.f;
+
+	// chunks lose one octree depth per ring of this many chunks around the camera, 0 keeps every chunk at max_depth. the rings only move in steps of their width
+	UPROPERTY(Config, EditAnywhere, Category = "Level of Detail", meta = (ClampMin = 0))
+	int32 lod_ring_width = 0;
+
+	// depth the outer rings bottom out at
+	UPROPERTY(Config, EditAnywhere, Category = "Level of Detail", meta = (EditCondition = "lod_ring_width > 0", ClampMin = 2, ClampMax = 10))
+	int32 lod_min_depth = 3;
+
+	// how chunks keep their density samples around for reapplying edits. quantized modes store densities relative to the iso surface
+	UPROPERTY(Config, EditAnywhere, Category = "Memory")
+	NoiseFieldStorage noise_field_storage = NoiseFieldStorage::Raw;
+
+	// densities further than this from the iso surface are clamped when quantized
+	UPROPERTY(Config, EditAnywhere, Category = "Memory", meta = (EditCondition = "noise_field_storage != NoiseFieldStorage::Raw", EditConditionHides, ClampMin = 0.001))
+	float noise_field_range = 1.f;
+
+	// keep every chunk's edge intersections and normals, octree settings changes rebuild the trees from them without sampling any noise
+	UPROPERTY(Config, EditAnywhere, Category = "Memory")
+	bool keep_hermite_data = false;
+
+	// chunks leaving the load area are kept as they are up to this many megabytes and come back without any task, 0 turns it off.
+	// loaded chunks keep a copy of their interior mesh while it is on, chunks pushed out of it go on to the region cache
+	UPROPERTY(Config, EditAnywhere, Category = "Memory", meta = (ClampMin = 0))
+	int32 evicted_chunk_budget_mb = 0;
+
+	// evicted chunks are written to region files under Saved/DCRegionCache and built again from them without sampling, edits included
+	UPROPERTY(Config, EditAnywhere, Category = "Region Cache")
+	bool use_region_cache = false;
+
 	UPROPERTY(EditAnywhere, Config, Category = "Rendering", meta = (AllowedClasses = "/Script/Engine.MaterialInterface"))
 	TSoftObjectPtr<UMaterialInterface> terrain_material;
 
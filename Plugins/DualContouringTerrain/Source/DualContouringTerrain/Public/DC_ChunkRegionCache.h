@@ -0,0 +1,133 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "DC_OctreeNode.h"
+#include "DC_SDFOps.h"
+#include <atomic>
+
+struct ChunkNoiseField;
+class IMappedFileHandle;
+class IMappedFileRegion;
+class FQueuedThreadPool;
+
+// uncompressed part of a cached chunk, checked against the chunk before its payload is decoded
+struct DUALCONTOURINGTERRAIN_API ChunkCacheHeader
+{
+	//everything the stored noise field depends on
+	uint32 noise_hash = 0;
+	//everything the stored normals depend on, hermite data of another hash is dropped
+	uint32 hermite_hash = 0;
+	//depths of the neighbours the field was snapped against, 0 without lod rings
+	uint32 lod_key = 0;
+	int32 depth = 0;
+	int32 raw_size = 0;
+	int32 compressed_size = 0;
+};
+
+// a chunk as it sits in its region file, the payload is still lz4 compressed
+struct DUALCONTOURINGTERRAIN_API ChunkCacheRecord
+{
+	ChunkCacheHeader header;
+	TArray<uint8> payload;
+};
+
+// on disk store of evicted chunks, region_dim^3 chunks per file. a file holds a fixed table of record offsets
+// followed by the records, rewritten records are appended and the file is compacted once more than half of it is dead.
+// the game thread only hands records over and kicks off flushes, every file is opened, mapped, read and written on the pool.
+// Read is safe from any thread, everything else is game thread only
+class DUALCONTOURINGTERRAIN_API ChunkRegionCache
+{
+public:
+	static constexpr int32 region_dim = 16;
+
+	ChunkRegionCache() = default;
+	~ChunkRegionCache();
+
+	ChunkRegionCache(const ChunkRegionCache&) = delete;
+	ChunkRegionCache& operator=(const ChunkRegionCache&) = delete;
+
+	// region files are kept in directory, nothing is read before the first lookup. flushes run on pool
+	void Init(const FString& new_directory, FQueuedThreadPool& pool);
+	// waits for the flushes in flight, writes what is left and unmaps every region, files stay on disk.
+	// no Read may be running
+	void Reset();
+	FORCEINLINE bool IsInitialized() const { return !directory.IsEmpty(); }
+
+	// false if the chunk was never written. blocks on file io, call it from the pool
+	bool Read(const FIntVector3& coord, ChunkCacheRecord& record);
+	// held in memory until a flush wrote it, Read finds it right away
+	void Write(const FIntVector3& coord, ChunkCacheRecord&& record);
+	// starts a pool task per region with held records and no flush in flight
+	void Flush();
+
+	// worker side, lz4 compresses the chunk's noise field, sdf ops and hermite data into record
+	static void EncodePayload(ChunkNoiseField& noise_field, TArray<FSDFOp>& sdf_ops, HermiteData& hermite, ChunkCacheRecord& record);
+	static bool DecodePayload(const ChunkCacheRecord& record, ChunkNoiseField& noise_field, TArray<FSDFOp>& sdf_ops, HermiteData& hermite);
+
+private:
+	struct TableEntry
+	{
+		uint64 offset;
+		uint32 size;
+		uint32 reserved;
+	};
+
+	struct Region
+	{
+		//held for every file access of the region, pool threads only
+		FCriticalSection file_lock;
+		bool loaded = false;
+		TArray<TableEntry> table;
+		//bytes of live records, the rest of the file past the table is dead
+		uint64 live_bytes = 0;
+		uint64 file_size = 0;
+		IMappedFileHandle* mapped_file = nullptr;
+		IMappedFileRegion* mapped_region = nullptr;
+		std::atomic<uint64> last_used = 0;
+
+		//guards the two record maps, never held across file io so Write doesn't stall the game thread
+		FCriticalSection records_lock;
+		//by record index, handed over by Write
+		TMap<int32, ChunkCacheRecord> pending_writes;
+		//taken from pending_writes by the flush in flight, dropped once the table points at them
+		TMap<int32, ChunkCacheRecord> flushing_writes;
+		//game thread only
+		TFuture<void> flush;
+	};
+
+	static constexpr uint32 file_magic = 0x44435247;
+	static constexpr uint32 file_version = 2;
+	static constexpr int32 records_per_region = region_dim * region_dim * region_dim;
+	static constexpr int64 table_offset = 2 * sizeof(uint32);
+	static constexpr int64 records_offset = table_offset + records_per_region * sizeof(TableEntry);
+	//regions the camera left are unmapped once more than this many are mapped
+	static constexpr int32 max_mapped_regions = 8;
+
+	Region& FindOrAddRegion(const FIntVector3& region_coord);
+	// reads the table on first use, file_lock held
+	void LoadRegion(const FIntVector3& region_coord, Region& region);
+	// file_lock held
+	bool MapRegion(const FIntVector3& region_coord, Region& region);
+	void UnmapRegion(Region& region);
+	// skips regions whose file_lock is taken, the caller holds its own
+	void UnmapLeastRecentlyUsed(const Region& caller);
+	// appends the held records with one file open, rewrites the table once and compacts the file if it needs to. runs on the pool
+	void FlushRegion(const FIntVector3& region_coord, Region& region);
+	// rewrites the file with only its live records, file_lock held
+	void CompactRegion(const FIntVector3& region_coord, Region& region);
+	FString GetRegionPath(const FIntVector3& region_coord) const;
+
+	static FIntVector3 GetRegionCoord(const FIntVector3& coord);
+	static int32 GetRecordIndex(const FIntVector3& coord);
+
+	FString directory;
+	FQueuedThreadPool* thread_pool = nullptr;
+	//regions are never removed before Reset, references to them stay valid without regions_lock
+	TMap<FIntVector3, TUniquePtr<Region>> regions;
+	FCriticalSection regions_lock;
+	std::atomic<int32> num_mapped = 0;
+	std::atomic<uint64> use_counter = 0;
+};
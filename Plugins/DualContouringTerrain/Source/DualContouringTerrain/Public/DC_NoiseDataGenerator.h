@@ -60,8 +60,26 @@ public:
 	[[nodiscard]] static TArray<float> GetNoiseFromPositions3D_NonThreaded(const float* x_pos, const float* y_pos, const float* z_pos, int count, int32 seed);
 	[[nodiscard]] static float GetNoiseSingle3D(float x, float y, float z, int32 seed);
 
+	// grid points of depth d are chunk_size / 2^d apart, call again when the chunk size changes
+	static void SetGridChunkSize(float chunk_size);
+
+	// samples the grid box [start, start + size) of depth into a z fastest out_dim^3 field (UOctreeCode::Get1DIndexFrom3D layout) at out_offset
+	static void GetNoiseUniformGrid3D(float* out, int32 out_dim, const FIntVector3& out_offset, const FIntVector3& start, const FIntVector3& size, int32 depth, int32 seed);
+
+	// everything the sampled noise depends on besides the seed: the node tree, the finalizer scale and the sample offset
+	static uint32 GetGeneratorHash();
+
+	static constexpr int32 max_grid_depth = 10;
+
 private:
 	static FastNoise::SmartNode<FastNoise::Generator> generator;
 	static FastNoise::SmartNode<FastNoise::DomainOffset> finalizer_offset;
 	static FastNoise::SmartNode<FastNoise::DomainScale> finalizer_scale;
+	// one scale node per octree depth in front of finalizer_offset, maps integer grid positions to sample space
+	static FastNoise::SmartNode<FastNoise::DomainScale> grid_scales[max_grid_depth + 1];
+
+	// fastnoise nodes can't be queried, what they were set up with is kept for GetGeneratorHash
+	static FString encoded_node_tree;
+	static float finalizer_scaling;
+	static FVector sample_offset;
 };
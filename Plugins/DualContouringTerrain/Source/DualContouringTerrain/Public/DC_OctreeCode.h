@@ -24,6 +24,41 @@ namespace RealtimeMesh
 
 using MeshBuilder = RealtimeMesh::TRealtimeMeshBuilderLocal<uint32, FPackedNormal, FVector2DHalf, 1, uint16>;
 
+// edge intersections (scaled) of every leaf of a chunk, grouped per leaf in leaves order
+struct LeafIntersectionBatch
+{
+	// stays empty for the uniform leaf grid, which has no nodes
+	TArray<OctreeNode*> leaves;
+	TArray<uint8> intersection_counts;
+	TArray<FVector3f> intersections;
+	// HermiteData key of every intersection
+	TArray<uint32> edges;
+};
+
+// voxel with a sign change, index is its Get1DIndexFrom3D index among the 2^max_depth voxels per axis
+struct ActiveCell
+{
+	int32 index;
+	uint8 corners;
+	uint16 edge_mask;
+};
+
+// per depth flags whether a cell holds a sign change, depth max_depth being the voxels.
+// cells are indexed like the noise field, with GetDim(depth) cells per axis
+struct SignPyramid
+{
+	TArray<TArray<uint8>> levels;
+	// corner sign mask of every voxel, bit i is set for a solid corner i
+	TArray<uint8> voxel_corners;
+	TArray<ActiveCell> active_cells;
+
+	FORCEINLINE bool IsActive(int32 depth, const FIntVector3& cell) const
+	{
+		const int32 dim = 1 << depth;
+		return levels[depth][cell.Z + cell.Y * dim + cell.X * dim * dim] != 0;
+	}
+};
+
 UCLASS()
 class DUALCONTOURINGTERRAIN_API UOctreeCode : public UEngineSubsystem
 {
@@ -34,16 +69,39 @@ public:
 	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
 	virtual void Deinitialize() override;
 	
-	// builds an octree and returns it
-	static TUniquePtr<OctreeNode> BuildOctree(FVector3f center, float size, const OctreeSettingsMultithreadContext& settings_context, const TArray<float>& noise);
-	static TUniquePtr<OctreeNode> RebuildOctree(FVector3f center, float size, const OctreeSettingsMultithreadContext& settings_context, const TArray<float>& noise, const TArray<FSDFOp>& sdf_ops);
+	// builds an octree out of nodes allocated from arena and returns its root. arena is released if the chunk holds no surface.
+	// hermite may be null. edges found in it keep their intersection and normal instead of being sampled, afterwards it holds the edges of the built surface
+	static OctreeNode* BuildOctree(FVector3f center, float size, const OctreeSettingsMultithreadContext& settings_context, const TArray<float>& noise, OctreeNodeArena& arena, HermiteData* hermite);
+	static OctreeNode* RebuildOctree(FVector3f center, float size, const OctreeSettingsMultithreadContext& settings_context, const TArray<float>& noise, const TArray<FSDFOp>& sdf_ops, OctreeNodeArena& arena, HermiteData* hermite);
+	// rebuilds only the cells of an existing tree touching region (world space), the rest of the tree is kept. root may be null.
+	// edges of the rebuilt cells in hermite (may be null) are replaced, they are always sampled again
+	static OctreeNode* RebuildOctreeRegion(OctreeNode* root, FVector3f center, float size, const OctreeSettingsMultithreadContext& settings_context, const TArray<float>& noise, const TArray<FSDFOp>& sdf_ops, const FBox3f& region, OctreeNodeArena& arena, HermiteData* hermite);
+
+	// linear octree variants, tree is left empty if the chunk holds no surface
+	static void BuildOctree(FVector3f center, float size, const OctreeSettingsMultithreadContext& settings_context, const TArray<float>& noise, LinearOctree& tree, HermiteData* hermite);
+	static void RebuildOctree(FVector3f center, float size, const OctreeSettingsMultithreadContext& settings_context, const TArray<float>& noise, const TArray<FSDFOp>& sdf_ops, LinearOctree& tree, HermiteData* hermite);
+
+	// unsimplified tree with the collapse of every internal node kept, tree is left empty if the chunk holds no surface. sdf_ops may be null
+	static void BuildProgressiveOctree(FVector3f center, float size, const OctreeSettingsMultithreadContext& settings_context, const TArray<float>& noise, const TArray<FSDFOp>* sdf_ops, ProgressiveOctree& progressive, HermiteData* hermite);
+	// simplified linear octree at settings_context's threshold (none if simplify is off), nodes at depth_cut and above it collapse regardless of their error
+	static void ExtractOctree(const ProgressiveOctree& progressive, const OctreeSettingsMultithreadContext& settings_context, int32 depth_cut, LinearOctree& tree);
+
+	// flat leaf grid for unsimplified chunks, no node hierarchy at all. grid is left empty if the chunk holds no surface. sdf_ops may be null
+	static void BuildUniformLeafGrid(FVector3f center, float size, const OctreeSettingsMultithreadContext& settings_context, const TArray<float>& noise, const TArray<FSDFOp>* sdf_ops, UniformLeafGrid& grid, HermiteData* hermite);
 	
 	//get octree node from position p inside starting (parent) node, at depth depth.
-	TUniquePtr<OctreeNode>* GetNodeFromPositionDepth(OctreeNode* start, FVector3f p, int8 depth) const;
+	OctreeNode** GetNodeFromPositionDepth(OctreeNode* start, FVector3f p, int8 depth) const;
 
-	//input: specific ordering of the main node and all its neighbor nodes
-	static RealtimeMesh::FRealtimeMeshStreamSet PolygonizeOctree(const TArray<OctreeNode*, TInlineAllocator<8>>& nodes, bool negative_delta);
-	static RealtimeMesh::FRealtimeMeshStreamSet PolygonizeOctree(const TArray<OctreeNode*, TInlineAllocator<8>>& nodes, const TArray<OctreeNode*, TInlineAllocator<8>>& ec_nodes, bool negative_delta);
+	// vertices and quads of everything inside one chunk, run by the creation task while the tree is still warm
+	static RealtimeMesh::FRealtimeMeshStreamSet PolygonizeInterior(OctreeNode* root);
+	static RealtimeMesh::FRealtimeMeshStreamSet PolygonizeInterior(const LinearOctree& tree);
+	static RealtimeMesh::FRealtimeMeshStreamSet PolygonizeInterior(const UniformLeafGrid& grid);
+
+	//input: specific ordering of the main node and all its neighbor nodes. only the seam strip between them, its own section group
+	static RealtimeMesh::FRealtimeMeshStreamSet PolygonizeSeam(const TArray<OctreeNode*, TInlineAllocator<8>>& nodes, bool negative_delta);
+	static RealtimeMesh::FRealtimeMeshStreamSet PolygonizeSeam(const TArray<const LinearOctree*, TInlineAllocator<8>>& trees, bool negative_delta);
+	// uniform leaf grids of the main chunk and its neighbours, same ordering. edges are scanned linearly, no seam octree is built
+	static RealtimeMesh::FRealtimeMeshStreamSet PolygonizeSeam(const TArray<const UniformLeafGrid*, TInlineAllocator<8>>& grids, bool negative_delta);
 
 	static FORCEINLINE int32 GetDim(int32 depth) { return 1 << depth;};
 	static FORCEINLINE int32 Get1DIndexFrom3D(int32 x, int32 y, int32 z, int32 dim)
@@ -55,19 +113,69 @@ public:
 	void DebugDrawOctree(UWorld* world, OctreeNode* node, int32 current_depth, bool draw_leaves, bool draw_simple_leaves, int32 how_deep);
 private:
 
-	static void ConstructLeafNode(OctreeNode* node, const FVector3f& node_p, const float* corner_densities, uint8 corners, const OctreeSettingsMultithreadContext& settings_context);
-	static void ConstructLeafNode_Edit(OctreeNode* node, const FVector3f& node_p, const float* corner_densities, uint8 corners, const OctreeSettingsMultithreadContext& settings_context, const TArray<FSDFOp>& sdf_ops);
+	// shared by Build and Rebuild, sdf_ops is null for unedited chunks
+	static OctreeNode* BuildOctreeFromNoise(FVector3f center, float size, const OctreeSettingsMultithreadContext& settings_context, const TArray<float>& noise, const TArray<FSDFOp>* sdf_ops, OctreeNodeArena& arena, HermiteData* hermite);
+	// builds, finalizes and simplifies every root octant on its own worker, then only the root is left to collapse
+	static OctreeNode* BuildOctreeOctants(OctreeNode* root, const SignPyramid& pyramid, const OctreeSettingsMultithreadContext& settings_context, const TArray<float>& noise, const TArray<FSDFOp>* sdf_ops, OctreeNodeArena& arena, const HermiteData* known_hermite, HermiteData* hermite);
+	// RebuildOctreeRegion split the same way, the rebuild boxes are clipped to each octant
+	static OctreeNode* RebuildOctreeRegionOctants(OctreeNode* root, const OctreeSettingsMultithreadContext& settings_context, const TArray<float>& noise, const TArray<FSDFOp>& sdf_ops, const TArray<TPair<FIntVector3, FIntVector3>>& rebuild_boxes, const FIntVector3& dirty_min, const FIntVector3& dirty_max, OctreeNodeArena& arena, HermiteData* hermite);
+
+	// corner masks of every voxel in the inclusive box, straight from the noise field. voxel_corners (optional) is sized for the whole chunk
+	static void ClassifyVoxels(const TArray<float>& noise, const OctreeSettingsMultithreadContext& settings_context, const FIntVector3& vox_min, const FIntVector3& vox_max, TArray<ActiveCell>& active_cells, TArray<uint8>* voxel_corners);
+	// or-reduces the active voxels of noise up to the root
+	static void BuildSignPyramid(const TArray<float>& noise, const OctreeSettingsMultithreadContext& settings_context, SignPyramid& pyramid);
+	// top down construction below node, only descends into cells the pyramid marks active. node_cell is node's cell at its depth
+	static void ConstructLeafNodes(OctreeNode* node, const FIntVector3& node_cell, const SignPyramid& pyramid, const TArray<float>& noise, const OctreeSettingsMultithreadContext& settings_context, OctreeNodeArena& arena, LeafIntersectionBatch& batch);
+	// constructs the leaves of every active voxel in the inclusive voxel box
+	static void ConstructLeafNodes(OctreeNode* root, const FIntVector3& vox_min, const FIntVector3& vox_max, const TArray<float>& noise, const OctreeSettingsMultithreadContext& settings_context, OctreeNodeArena& arena, LeafIntersectionBatch& batch);
+	// places the leaf and appends its edge intersections to batch, qef and minimizer are filled in by FinalizeLeafNodes
+	static void ConstructLeafNode(OctreeNode* node, const FVector3f& node_p, const FIntVector3& cell, const float* corner_densities, uint8 corners, const OctreeSettingsMultithreadContext& settings_context, OctreeNodeArena& arena, LeafIntersectionBatch& batch);
+	// marks an already placed max depth node (voxel cell) as leaf and appends its edge intersections to batch
+	static void EmitLeafNode(OctreeNode* node, const FIntVector3& cell, const float* corner_densities, uint8 corners, const OctreeSettingsMultithreadContext& settings_context, LeafIntersectionBatch& batch);
+	// normal of every intersection of batch, closed form on sdf op surfaces if enabled, else fdm samples in one noise call.
+	// intersections on an edge of known_hermite (may be null) take its position and normal instead
+	static void SampleIntersectionNormals(LeafIntersectionBatch& batch, float leaf_size, const OctreeSettingsMultithreadContext& settings_context, const TArray<FSDFOp>* sdf_ops, const HermiteData* known_hermite, TArray<FVector3f>& normals);
+	// qef minimizer of every leaf of batch, qefs (optional) gets the accumulated quadrics
+	static void SolveLeafQEFs(const LeafIntersectionBatch& batch, const TArray<FVector3f>& normals, const OctreeSettingsMultithreadContext& settings_context, TArray<FVector3f>& minimizers, TArray<quadric3>* qefs);
+	// samples fdm normals for every intersection in one noise call and builds the leaf qefs. the edges are appended to hermite (may be null) unsorted
+	static void FinalizeLeafNodes(LeafIntersectionBatch& batch, const OctreeSettingsMultithreadContext& settings_context, const TArray<FSDFOp>* sdf_ops, const HermiteData* known_hermite, HermiteData* hermite);
 
 	static StitchOctreeNode* ConstructSeamOctree(const TArray<OctreeNode*, TInlineAllocator<8>>& seam_nodes, bool negative_delta, MeshBuilder& builder);
+	static StitchOctreeNode* ConstructSeamOctree(const TArray<const LinearOctree*, TInlineAllocator<8>>& seam_trees, bool negative_delta, MeshBuilder& builder);
+
+	// flattens a pointer octree breadth first into tree
+	static void LinearizeOctree(const OctreeNode* root, LinearOctree& tree);
+	// drops nodes below collapsed leaves and rewrites the arrays in breadth first order
+	static void CompactOctree(LinearOctree& tree);
+	// collapses every internal node of a linearized, unsimplified tree level by level into new leaf data, same math as SimplifyOctreeBatched
+	static void FinalizeProgressiveOctree(ProgressiveOctree& progressive, bool batched_qef);
 
 	// get node size from depth, could be tableized
 	FORCEINLINE float SizeFromNodeDepth(uint8 depth) { return 0.f / std::exp2f(static_cast<float>(depth)); };
 
 	// simplify the octree with residual error
 	static bool SimplifyOctree(OctreeNode* node, float simplify_threshold);
+	// tries to collapse node into a leaf, its children have to be simplified already. collapsed children go back to arena if given
+	static bool SimplifyOctreeNode(OctreeNode* node, float simplify_threshold, OctreeNodeArena* arena = nullptr);
+	// same result as SimplifyOctree, but goes level by level bottom up and solves every candidate of a level as one QuadricBatch
+	static void SimplifyOctreeBatched(OctreeNode* root, float simplify_threshold, OctreeNodeArena* arena = nullptr);
+
+	// region rebuild helpers, nodes are addressed by their inclusive voxel box (node_min, node_extent voxels per axis)
+	// resets every cell touching the region and collects the voxel boxes that need their leaves constructed again
+	static void DetachOctreeRegion(OctreeNode* node, const FIntVector3& node_min, int32 node_extent, const FIntVector3& region_min, const FIntVector3& region_max, OctreeNodeArena& arena, TArray<TPair<FIntVector3, FIntVector3>>& rebuild_boxes);
+	// frees internal nodes left without children, returns false if node itself was freed
+	static bool PruneOctreeRegion(OctreeNode* node, const FIntVector3& node_min, int32 node_extent, const FIntVector3& region_min, const FIntVector3& region_max, OctreeNodeArena& arena);
+	// simplifies only the nodes touching the region, everything else keeps its previous result
+	static bool SimplifyOctreeRegion(OctreeNode* node, const FIntVector3& node_min, int32 node_extent, const FIntVector3& region_min, const FIntVector3& region_max, float simplify_threshold, OctreeNodeArena& arena);
+	static void SimplifyOctree(LinearOctree& tree, float simplify_threshold);
+	static void SimplifyOctreeBatched(LinearOctree& tree, float simplify_threshold);
 
 	// Build vertex buffer and assign indices to leaf data
 	static void BuildMeshData(OctreeNode* node, MeshBuilder& builder);
+	// linear octree vertices are the leaf data arrays as is, vertex i is leaf_data_idx i
+	static void BuildMeshData(const LinearOctree& tree, MeshBuilder& builder);
+	// same for the uniform grid, vertex i is the i-th active voxel. has to run before any other vertex is added
+	static void BuildMeshData(const UniformLeafGrid& grid, MeshBuilder& builder);
 
 	void BuildStitchMeshData(OctreeNode* node, OctreeNode* parent, MeshBuilder& builder);
 
@@ -81,6 +189,17 @@ private:
 	static void DC_ProcessFace(StitchOctreeNode* node_1, StitchOctreeNode* node_2, unsigned char direction, MeshBuilder& builder);
 	static void DC_ProcessEdge(StitchOctreeNode* node_1, StitchOctreeNode* node_2, StitchOctreeNode* node_3, StitchOctreeNode* node_4, unsigned char direction, MeshBuilder& builder);
 
+	// DC polygonization methods (linear octree, nodes are indices into tree.nodes)
+	static void DC_ProcessCell(const LinearOctree& tree, uint32 node, MeshBuilder& builder);
+	static void DC_ProcessFace(const LinearOctree& tree, uint32 node_1, uint32 node_2, unsigned char direction, MeshBuilder& builder);
+	static void DC_ProcessEdge(const LinearOctree& tree, uint32 node_1, uint32 node_2, uint32 node_3, uint32 node_4, unsigned char direction, MeshBuilder& builder);
+
+	// DC polygonization methods (uniform leaf grid). every edge is handled by its owner voxel, the one at its min side in the other two axes
+	// quads of every edge whose 4 voxels are all inside grid
+	static void DC_ProcessGrid(const UniformLeafGrid& grid, MeshBuilder& builder);
+	// quads of the edges crossing from the main chunk into its neighbours (negative_delta) or the other way around
+	static void DC_ProcessGridSeam(const TArray<const UniformLeafGrid*, TInlineAllocator<8>>& grids, bool negative_delta, MeshBuilder& builder);
+
 	//returns the root stitch node copy of start_node
 	//StitchOctreeNode* ConstructSeamOctree(OctreeNode* start_node, uint8 node_idx, OctreeNode* parent_node, MeshBuilder& builder);
 
@@ -91,9 +210,11 @@ private:
 	void DebugDrawNode(UWorld* world, OctreeNode* node, float size, FColor color);
 	void DebugDrawNodeMinimizer(OctreeNode* node);
 
-	// get normal via fdm 
-	static FVector3f FDMGetNormal(const FVector3f& at_point, float h, int32 seed);
-	static FVector3f FDMGetNormal_SDF(const FVector3f& at_point, float h, int32 seed, const TArray<FSDFOp>& sdf_ops);
+	// closed form gradient of the sdf op winning the csg chain at p, noise_density is the plain noise at p.
+	// false if the noise wins or the op's gradient is ambiguous there
+	static bool GetSDFOpsGradient(const FVector3f& p, float noise_density, float iso_surface, float eps, const TArray<FSDFOp>& sdf_ops, FVector3f& out_gradient);
+	// applies sdf_ops in order to already sampled noise values at the given (scaled) positions
+	static void ApplySDFOps(float* noise, const float* x_positions, const float* y_positions, const float* z_positions, int32 count, const TArray<FSDFOp>& sdf_ops);
 
 	// get child index containing p from node position
 	static FORCEINLINE uint8 GetChildNodeFromPosition(const FVector3f& p, const FVector3f& node_center)
@@ -28,13 +28,13 @@ struct DUALCONTOURINGTERRAIN_API StitchOctreeNode
 	int32 tri_index;
 };
 
+// nodes are owned by the OctreeNodeArena of their chunk, children are never deleted individually
 struct DUALCONTOURINGTERRAIN_API OctreeNode
 {
 public:
 	OctreeNode() = default;
-	~OctreeNode();
 
-	TUniquePtr<OctreeNode> children[8] = {nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr};
+	OctreeNode* children[8] = {nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr};
 	FVector3f center = FVector3f::ZeroVector;
 	int8 depth = 0;
 	unsigned char type = NODE_INTERNAL;
@@ -52,17 +52,57 @@ public:
 	float size;
 };
 
+// per chunk slab allocator for OctreeNodes. nodes are bump allocated out of fixed size blocks
+// and all of them are released in one go, instead of one malloc / free per node.
+// nodes handed back through Free are reused by later allocations of the same arena.
+struct DUALCONTOURINGTERRAIN_API OctreeNodeArena
+{
+public:
+	OctreeNodeArena() = default;
+	~OctreeNodeArena();
+
+	OctreeNodeArena(const OctreeNodeArena&) = delete;
+	OctreeNodeArena& operator=(const OctreeNodeArena&) = delete;
+
+	OctreeNodeArena(OctreeNodeArena&& other) noexcept;
+	OctreeNodeArena& operator=(OctreeNodeArena&& other) noexcept;
+
+	// returns a zero initialized node
+	OctreeNode* Allocate();
+
+	// puts node (or node and everything below it) on the free list
+	void Free(OctreeNode* node);
+	void FreeSubtree(OctreeNode* node);
+
+	// takes over every block and free node of other, nodes of both arenas are released together from now on
+	void Append(OctreeNodeArena&& other);
+
+	// frees every node allocated from this arena, pointers into it are dangling afterwards
+	void Release();
+
+	FORCEINLINE int32 Num() const { return num_allocated; }
+	FORCEINLINE SIZE_T GetAllocatedSize() const { return static_cast<SIZE_T>(blocks.Num()) * nodes_per_block * sizeof(OctreeNode); }
+
+private:
+	static constexpr int32 nodes_per_block = 1024;
+
+	TArray<OctreeNode*> blocks;
+	TArray<OctreeNode*> free_nodes;
+	int32 block_offset = nodes_per_block;
+	int32 num_allocated = 0;
+};
+
 constexpr uint32 INDEX_NOEXIST = MAX_uint32;
 
 struct DUALCONTOURINGTERRAIN_API OctreeNode_smol
 {
 public:
-	uint32 first_child;
+	uint32 first_child = INDEX_NOEXIST;
 	uint8 depth = 0;
 	uint8 child_mask = 0;
 	uint8 type = NODE_INTERNAL;
 	uint8 corners = 0;
-	uint32 leaf_data_idx;
+	uint32 leaf_data_idx = INDEX_NOEXIST;
 
 	//get the index into the node storing array
 	FORCEINLINE uint32 GetChildIndex(unsigned char idx) const
@@ -83,3 +123,100 @@ public:
 		return (child_mask >> idx) & 1u;
 	}
 };
+
+// pointerless octree. nodes are stored breadth first in one array, so the children of a node are contiguous
+// and addressed through first_child + child_mask. leaf / collapsed leaf data lives in separate arrays indexed by leaf_data_idx.
+struct DUALCONTOURINGTERRAIN_API LinearOctree
+{
+public:
+	TArray<OctreeNode_smol> nodes;
+
+	TArray<FVector3f> minimizers;
+	TArray<FVector3f> normals;
+	TArray<quadric3> qefs;
+
+	FORCEINLINE bool IsEmpty() const { return nodes.IsEmpty(); }
+
+	void Reset();
+	SIZE_T GetAllocatedSize() const;
+};
+
+// unsimplified linear octree that keeps the collapse of every internal node. internal nodes get leaf data too
+// (accumulated qef, minimizer, averaged normal), so any simplify threshold or depth cut is a traversal, no noise is sampled again.
+struct DUALCONTOURINGTERRAIN_API ProgressiveOctree
+{
+public:
+	// every node has its leaf_data_idx set, internal nodes included
+	LinearOctree tree;
+
+	// per leaf data index: largest residual of any internal node in the subtree, the node collapses at every threshold at or above it. 0 for leaves
+	TArray<float> collapse_errors;
+	// per leaf data index: corner signs of the node once it is collapsed
+	TArray<uint8> collapse_corners;
+
+	FORCEINLINE bool IsEmpty() const { return tree.IsEmpty(); }
+
+	void Reset();
+	SIZE_T GetAllocatedSize() const;
+};
+
+// edge intersections of a chunk's surface and their normals, one entry per sign changing lattice edge sorted by key.
+// trees are built again from it and the noise field signs without sampling any normal
+struct DUALCONTOURINGTERRAIN_API HermiteData
+{
+public:
+	struct Edge
+	{
+		// lattice index of the edge's lower sample * 3 + the axis it runs along
+		uint32 key;
+		// scaled like the leaf qefs
+		FVector3f position;
+		FVector3f normal;
+	};
+
+	TArray<Edge> edges;
+
+	FORCEINLINE bool IsEmpty() const { return edges.IsEmpty(); }
+
+	// binary search, null if the edge has no intersection
+	const Edge* Find(uint32 key) const;
+	// sorts edges appended in leaf order, edges shared by several voxels are kept once
+	void Finalize();
+	// drops every edge of a voxel inside one of the inclusive voxel boxes and merges in the edges of their rebuild
+	void ReplaceRegion(HermiteData&& rebuilt, const TArray<TPair<FIntVector3, FIntVector3>>& boxes, int32 vox_dim);
+
+	void Reset();
+	SIZE_T GetAllocatedSize() const;
+};
+
+// unsimplified chunk without any node hierarchy: a bit per max depth voxel marks the ones holding a vertex,
+// vertex data of the active voxels is stored in voxel index order. the rank of a voxel among the active ones is its vertex.
+struct DUALCONTOURINGTERRAIN_API UniformLeafGrid
+{
+public:
+	// voxels per axis
+	int32 dim = 0;
+
+	TArray<uint64> active_words;
+	// active voxels before every word of active_words
+	TArray<uint32> word_offsets;
+
+	TArray<FVector3f> minimizers;
+	TArray<FVector3f> normals;
+	TArray<uint8> corners;
+
+	FORCEINLINE bool IsEmpty() const { return minimizers.IsEmpty(); }
+
+	// vertex of voxel or INDEX_NOEXIST if it has no sign change
+	FORCEINLINE uint32 FindVertex(int32 voxel) const
+	{
+		const uint64 word = active_words[voxel >> 6];
+		const uint64 bit = 1ull << (voxel & 63);
+		if (!(word & bit)) return INDEX_NOEXIST;
+
+		return word_offsets[voxel >> 6] + static_cast<uint32>(FMath::CountBits(word & (bit - 1)));
+	}
+
+	void Reset();
+	SIZE_T GetAllocatedSize() const;
+};
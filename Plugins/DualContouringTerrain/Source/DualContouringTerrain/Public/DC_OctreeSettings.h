@@ -13,6 +13,20 @@ enum class EOctreeDebugDrawMode
 	Point
 };
 
+// how far back the chunk pipeline has to restart after a settings change, every level includes the ones below it
+enum class SettingsInvalidation : uint8
+{
+	None = 0,
+	//cut the progressive octrees again
+	Recut = 1,
+	//build the trees again from the kept noise fields, normals come from the kept hermite data
+	Octree = 2,
+	//sample the intersection normals again, noise fields are kept
+	Hermite = 3,
+	//sample everything again
+	Noise = 4
+};
+
 UCLASS(Config=Game, DefaultConfig)
 class DUALCONTOURINGTERRAIN_API UOctreeSettings : public UDeveloperSettings
 {
@@ -38,6 +52,30 @@ public:
 	UPROPERTY(Config, EditAnywhere, AdvancedDisplay)
 	float normal_fdm_offset = 0.01f;
 
+	// take normals on sdf op surfaces from their closed form gradients, only noise surfaces use fdm
+	UPROPERTY(Config, EditAnywhere, AdvancedDisplay)
+	bool analytic_gradients = false;
+
+	// accumulate and solve leaf / simplification qefs 4 cells per simd instruction, off uses the scalar quadric3 path
+	UPROPERTY(Config, EditAnywhere, AdvancedDisplay)
+	bool batched_qef = true;
+
+	// store chunk octrees breadth first in flat arrays instead of pointer linked nodes
+	UPROPERTY(Config, EditAnywhere, AdvancedDisplay)
+	bool linear_octree = false;
+
+	// keep the unsimplified linear octree with the qef and error of every node, simplify_threshold changes only cut chunks again instead of resampling them
+	UPROPERTY(Config, EditAnywhere, AdvancedDisplay)
+	bool progressive_octree = false;
+
+	// build and simplify the 8 root octants of an edited chunk on separate workers, cuts single chunk edit latency
+	UPROPERTY(Config, EditAnywhere, AdvancedDisplay)
+	bool parallel_octant_build = false;
+
+	// with simplify off, mesh chunks straight from a flat grid of max depth voxels instead of building an octree. edits rebuild the whole chunk grid instead of only the touched region
+	UPROPERTY(Config, EditAnywhere, AdvancedDisplay)
+	bool uniform_leaf_grid = false;
+
 	UPROPERTY(Config, EditAnywhere, AdvancedDisplay)
 	float stddev_pos = 0.01f;
 
@@ -74,8 +112,17 @@ struct OctreeSettingsMultithreadContext
 	bool simplify;
 	float simplify_threshold;
 	float normal_fdm_offset;
+	bool analytic_gradients;
+	bool batched_qef;
 	float stddev_pos;
 	float stddev_normal;
+	bool linear_octree;
+	bool progressive_octree;
+	bool parallel_octant_build;
+	bool uniform_leaf_grid;
 
 	OctreeSettingsMultithreadContext& operator=(const UOctreeSettings&);
+
+	// restart level for chunks built with built to match these settings. a lower max_depth is only absorbed by progressive octrees
+	SettingsInvalidation GetInvalidation(const OctreeSettingsMultithreadContext& built) const;
 };
\ No newline at end of file
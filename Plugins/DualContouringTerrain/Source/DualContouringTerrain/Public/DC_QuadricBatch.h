@@ -0,0 +1,38 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DC_OctreeNode.h"
+
+// quadrics of many cells stored as structure of arrays, so 4 cells are accumulated and solved per simd instruction.
+// same math as quadric3 (x^T A x - 2 b^T x + c), which stays the scalar reference.
+// the cell count is padded to a multiple of 4, padding cells hold the identity and are never read back
+struct DUALCONTOURINGTERRAIN_API QuadricBatch
+{
+public:
+	static constexpr int32 lanes = 4;
+
+	TArray<float> A00, A01, A02, A11, A12, A22;
+	TArray<float> b0, b1, b2;
+	TArray<float> c;
+
+	// zeroes cell_count quadrics
+	void Init(int32 cell_count);
+
+	FORCEINLINE int32 Num() const { return num; }
+
+	// adds the probabilistic plane quadrics of every cell. the planes of cell i are the plane_counts[i] positions / normals from plane_offsets[i] on
+	void AccumulatePlaneQuadrics(const int32* plane_offsets, const uint8* plane_counts, const FVector3f* positions, const FVector3f* normals, float stddev_pos, float stddev_normal);
+
+	// adds up to sources_per_cell quadrics to every cell, sources holds sources_per_cell entries per cell, nullptr ones are skipped
+	void AccumulateQuadrics(const quadric3* const* sources, int32 sources_per_cell);
+
+	// minimizer of every cell, errors (optional) gets the residual at the minimizer
+	void Solve(FVector3f* minimizers, float* errors) const;
+
+	quadric3 Get(int32 cell) const;
+
+private:
+	int32 num = 0;
+};
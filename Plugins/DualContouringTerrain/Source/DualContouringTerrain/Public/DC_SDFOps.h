@@ -10,6 +10,14 @@ class DUALCONTOURINGTERRAIN_API SDF
 public:
 	static float Box(const FVector3f& p, const FVector3f& extent);
 	static float Sphere(const FVector3f& p, float radius);
+
+	// 4 points at once, positions split per axis
+	static VectorRegister4Float Box(const VectorRegister4Float& px, const VectorRegister4Float& py, const VectorRegister4Float& pz, const FVector3f& extent);
+	static VectorRegister4Float Sphere(const VectorRegister4Float& px, const VectorRegister4Float& py, const VectorRegister4Float& pz, float radius);
+
+	// unit gradients, zero where the normal is ambiguous (box diagonals, sphere center)
+	static FVector3f BoxGradient(const FVector3f& p, const FVector3f& extent);
+	static FVector3f SphereGradient(const FVector3f& p, float radius);
 };
 
 UENUM()
@@ -46,5 +54,8 @@ struct DUALCONTOURINGTERRAIN_API FSDFOp
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	TEnumAsByte<SDFType> sdf_type = SDFType::Box;
+
+	// world space box outside of which applying this op can't change a density sign or a surface crossing
+	FBox3f GetInfluenceBounds() const;
 };
 